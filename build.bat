@@ -122,7 +122,7 @@ set cl_link_debug= /DEBUG
 set cl_out=      /Fe:
 
 set web_release=  -Os
-set web_platform= -DPLATFORM_WEB
+set web_platform= -DPLATFORM_WEB -msimd128
 set web_link=     -lraylib -L"raylib\lib\web" --shell-file shell.html -sUSE_GLFW=3 -sTOTAL_MEMORY=67108864 -sFORCE_FILESYSTEM=1 -sASYNCIFY -sEXPORTED_FUNCTIONS=_main,requestFullscreen -sEXPORTED_RUNTIME_METHODS=HEAPF32 --preload-file assets
 
 :: Choose Compile/Link Lines
@@ -115,7 +115,7 @@ script_choose_simple_lines()
     cc_out='-o'
 
     web_release='-Os'
-    web_platform='-DPLATFORM_WEB'
+    web_platform='-DPLATFORM_WEB -msimd128'
     web_link='-lraylib -L"raylib/lib/web" --shell-file shell.html -sUSE_GLFW=3 -sTOTAL_MEMORY=67108864 -sFORCE_FILESYSTEM=1 -sASYNCIFY -sEXPORTED_FUNCTIONS=_main,requestFullscreen -sEXPORTED_RUNTIME_METHODS=HEAPF32 preload-file assets'
 
     # Choose Lines
@@ -0,0 +1,186 @@
+// EXPLANATION:
+// Tracked heap allocation and arenas
+// See allocator.h for more documentation/descriptions
+
+#include "allocator.h"
+#include "threads.h"
+#include "raylib.h" // TraceLog
+
+#include <stdlib.h> // malloc, calloc, realloc, free
+#include <string.h> // memset
+#include <stdio.h>  // vsnprintf
+#include <stdarg.h> // va_list
+
+// Each allocation is prefixed with its size, padded to keep 16-byte alignment
+#define ALLOCATION_HEADER 16
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void ArenaOverflow(Arena *arena, size_t size);
+
+// Arenas
+Arena frameArena = { 0 };
+Arena stepArena = { 0 };
+Arena persistentArena = { 0 };
+
+// Counters, updated from any thread
+static volatile long long allocations = 0;
+static volatile long long frees = 0;
+static volatile long long bytesInUse = 0;
+static volatile long long peakBytesInUse = 0;
+static volatile long long libraryAllocations = 0;
+static volatile long long libraryFrees = 0;
+
+// Game allocations
+// ----------------------------------------------------------------------------
+
+void *GameAlloc(size_t size)
+{
+    unsigned char *block = calloc(1, size + ALLOCATION_HEADER);
+    if (block == NULL) return NULL;
+
+    *(size_t *)block = size;
+    AtomicAdd64(&allocations, 1);
+    long long inUse = AtomicAdd64(&bytesInUse, (long long)size);
+
+    // Peak is only raised, retry if another thread raised it meanwhile
+    long long peak = AtomicLoad64(&peakBytesInUse);
+    while ((inUse > peak) && !AtomicCompareExchange64(&peakBytesInUse, peak, inUse))
+        peak = AtomicLoad64(&peakBytesInUse);
+
+    return block + ALLOCATION_HEADER;
+}
+
+void GameFree(void *ptr)
+{
+    if (ptr == NULL) return;
+
+    unsigned char *block = (unsigned char *)ptr - ALLOCATION_HEADER;
+    AtomicAdd64(&frees, 1);
+    AtomicAdd64(&bytesInUse, -(long long)*(size_t *)block);
+    free(block);
+}
+
+AllocationStats GetAllocationStats(void)
+{
+    return (AllocationStats){
+        .allocations = (unsigned long long)AtomicLoad64(&allocations),
+        .frees = (unsigned long long)AtomicLoad64(&frees),
+        .bytesInUse = (size_t)AtomicLoad64(&bytesInUse),
+        .peakBytesInUse = (size_t)AtomicLoad64(&peakBytesInUse),
+        .libraryAllocations = (unsigned long long)AtomicLoad64(&libraryAllocations),
+        .libraryFrees = (unsigned long long)AtomicLoad64(&libraryFrees),
+    };
+}
+
+unsigned long long GetAllocationCount(void)
+{
+    return (unsigned long long)(AtomicLoad64(&allocations) + AtomicLoad64(&libraryAllocations));
+}
+
+// raylib allocations
+// ----------------------------------------------------------------------------
+
+void *TrackedMalloc(size_t size)
+{
+    AtomicAdd64(&libraryAllocations, 1);
+    return malloc(size);
+}
+
+void *TrackedCalloc(size_t count, size_t size)
+{
+    AtomicAdd64(&libraryAllocations, 1);
+    return calloc(count, size);
+}
+
+void *TrackedRealloc(void *ptr, size_t size)
+{
+    AtomicAdd64(&libraryAllocations, 1); // Touches the heap even when it grows in place
+    return realloc(ptr, size);
+}
+
+void TrackedFree(void *ptr)
+{
+    if (ptr == NULL) return;
+
+    AtomicAdd64(&libraryFrees, 1);
+    free(ptr);
+}
+
+// Arenas
+// ----------------------------------------------------------------------------
+
+void InitArena(Arena *arena, size_t capacity)
+{
+    *arena = (Arena){ 0 };
+    arena->memory = GameAlloc(capacity); // 16-byte aligned, same as ARENA_ALIGNMENT
+    if (arena->memory != NULL) arena->capacity = capacity;
+}
+
+void FreeArena(Arena *arena)
+{
+    if (arena->memory != NULL)
+        TraceLog(LOG_INFO, "ARENA: Peak use %u of %u bytes", (unsigned int)arena->peak, (unsigned int)arena->capacity);
+    GameFree(arena->memory);
+    *arena = (Arena){ 0 };
+}
+
+void ResetArena(Arena *arena)
+{
+    arena->used = 0;
+}
+
+void *ArenaAlloc(Arena *arena, size_t size)
+{
+    size_t start = (arena->used + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if ((start > arena->capacity) || (size > arena->capacity - start))
+    {
+        ArenaOverflow(arena, size);
+        return NULL;
+    }
+
+    // Memory is reused every reset, zero it like GameAlloc() does
+    unsigned char *block = arena->memory + start;
+    memset(block, 0, size);
+    arena->used = start + size;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+
+    return block;
+}
+
+const char *ArenaFormat(Arena *arena, const char *format, ...)
+{
+    // Written straight into the free space, then kept if it fit
+    size_t start = arena->used;
+    size_t space = arena->capacity - start;
+    if (space == 0)
+    {
+        ArenaOverflow(arena, 1);
+        return "";
+    }
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf((char *)arena->memory + start, space, format, args);
+    va_end(args);
+
+    if ((length < 0) || ((size_t)length >= space))
+    {
+        ArenaOverflow(arena, (length < 0)? 1 : (size_t)length + 1);
+        return "";
+    }
+
+    arena->used = start + (size_t)length + 1;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+
+    return (const char *)arena->memory + start;
+}
+
+static void ArenaOverflow(Arena *arena, size_t size)
+{
+    if (arena->overflowed) return;
+
+    TraceLog(LOG_WARNING, "ARENA: Out of memory, %u bytes requested with %u of %u used",
+             (unsigned int)size, (unsigned int)arena->used, (unsigned int)arena->capacity);
+    arena->overflowed = true;
+}
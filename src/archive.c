@@ -0,0 +1,220 @@
+// EXPLANATION:
+// Loads game assets from one packed archive file (assets.pak)
+// See archive.h for more documentation/descriptions
+
+#include "archive.h"
+
+#include <string.h> // memcmp, strcmp, strpbrk
+
+#if defined(PLATFORM_WEB)
+    // The archive is already in memory (preloaded), a plain read is enough
+#elif defined(_WIN32)
+    // Declared by hand, windows.h clashes with raylib's names
+    __declspec(dllimport) void *__stdcall CreateFileA(const char *fileName, unsigned long access, unsigned long shareMode,
+                                                      void *security, unsigned long creation, unsigned long flags, void *templateFile);
+    __declspec(dllimport) unsigned long __stdcall GetFileSize(void *file, unsigned long *fileSizeHigh);
+    __declspec(dllimport) void *__stdcall CreateFileMappingA(void *file, void *security, unsigned long protect,
+                                                             unsigned long maxSizeHigh, unsigned long maxSizeLow, const char *name);
+    __declspec(dllimport) void *__stdcall MapViewOfFile(void *mapping, unsigned long access, unsigned long offsetHigh,
+                                                        unsigned long offsetLow, size_t size);
+    __declspec(dllimport) int __stdcall UnmapViewOfFile(const void *address);
+    __declspec(dllimport) int __stdcall CloseHandle(void *handle);
+    #define WIN32_GENERIC_READ 0x80000000ul
+    #define WIN32_FILE_SHARE_READ 0x00000001ul
+    #define WIN32_OPEN_EXISTING 3ul
+    #define WIN32_PAGE_READONLY 0x02ul
+    #define WIN32_FILE_MAP_READ 0x0004ul
+    #define WIN32_INVALID_HANDLE ((void *)(long long)-1)
+#else
+    #include <fcntl.h>    // open
+    #include <unistd.h>   // close
+    #include <sys/mman.h> // mmap
+    #include <sys/stat.h> // fstat
+#endif
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static unsigned char *MapArchiveFile(const char *fileName, int *dataSize);
+static void UnmapArchiveFile(unsigned char *data, int dataSize);
+
+// The mapped archive
+static unsigned char *archiveData = NULL;
+static int archiveSize = 0;
+static const ArchiveEntry *archiveEntries = NULL;
+static int archiveEntryCount = 0;
+
+// Archive
+// ----------------------------------------------------------------------------
+
+bool OpenAssetArchive(const char *fileName)
+{
+    CloseAssetArchive();
+
+    // Packed into the working directory by make, or next to the executable
+    // (the build directory) by CMake
+    int size = 0;
+    unsigned char *data = MapArchiveFile(fileName, &size);
+    if ((data == NULL) && (strpbrk(fileName, "/\\") == NULL))
+    {
+        fileName = TextFormat("%s%s", GetApplicationDirectory(), fileName);
+        data = MapArchiveFile(fileName, &size);
+    }
+    if (data == NULL) return false;
+
+    // Check the header and that every entry lies inside the file
+    const ArchiveHeader *header = (const ArchiveHeader *)data;
+    bool valid = ((size_t)size >= sizeof(ArchiveHeader)) && (memcmp(header->magic, ARCHIVE_MAGIC, 4) == 0) &&
+                 (header->version == ARCHIVE_VERSION) &&
+                 (header->entryCount <= (size - sizeof(ArchiveHeader))/sizeof(ArchiveEntry));
+    const ArchiveEntry *entries = (const ArchiveEntry *)(data + sizeof(ArchiveHeader));
+    for (unsigned int i = 0; valid && (i < header->entryCount); i++)
+    {
+        valid = (entries[i].name[ARCHIVE_NAME_LENGTH - 1] == '\0') &&
+                (entries[i].offset <= (unsigned int)size) && (entries[i].size <= (unsigned int)size - entries[i].offset);
+    }
+
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "ARCHIVE: [%s] Not a version %i asset archive", fileName, ARCHIVE_VERSION);
+        UnmapArchiveFile(data, size);
+        return false;
+    }
+
+    archiveData = data;
+    archiveSize = size;
+    archiveEntries = entries;
+    archiveEntryCount = (int)header->entryCount;
+    TraceLog(LOG_INFO, "ARCHIVE: [%s] Mapped %i assets (%i KB)", fileName, archiveEntryCount, size/1024);
+    return true;
+}
+
+void CloseAssetArchive(void)
+{
+    if (archiveData == NULL) return;
+
+    UnmapArchiveFile(archiveData, archiveSize);
+    archiveData = NULL;
+    archiveSize = 0;
+    archiveEntries = NULL;
+    archiveEntryCount = 0;
+}
+
+bool IsAssetArchiveOpen(void)
+{
+    return (archiveData != NULL);
+}
+
+const unsigned char *GetAssetData(const char *fileName, int *dataSize)
+{
+    for (int i = 0; i < archiveEntryCount; i++)
+    {
+        if (strcmp(archiveEntries[i].name, fileName) == 0)
+        {
+            *dataSize = (int)archiveEntries[i].size;
+            return archiveData + archiveEntries[i].offset;
+        }
+    }
+
+    *dataSize = 0;
+    return NULL;
+}
+
+// Asset loading
+// ----------------------------------------------------------------------------
+
+Image LoadAssetImage(const char *fileName)
+{
+    int size = 0;
+    const unsigned char *data = GetAssetData(fileName, &size);
+    if (data == NULL) return LoadImage(fileName);
+
+    return LoadImageFromMemory(GetFileExtension(fileName), data, size);
+}
+
+Wave LoadAssetWave(const char *fileName)
+{
+    int size = 0;
+    const unsigned char *data = GetAssetData(fileName, &size);
+    if (data == NULL) return LoadWave(fileName);
+
+    return LoadWaveFromMemory(GetFileExtension(fileName), data, size);
+}
+
+Sound LoadAssetSound(const char *fileName)
+{
+    Wave wave = LoadAssetWave(fileName);
+    Sound sound = LoadSoundFromWave(wave);
+    UnloadWave(wave);
+
+    return sound;
+}
+
+Music LoadAssetMusicStream(const char *fileName)
+{
+    int size = 0;
+    const unsigned char *data = GetAssetData(fileName, &size);
+    if (data == NULL) return LoadMusicStream(fileName);
+
+    // Streams decode from the mapping while playing, so it must stay open
+    return LoadMusicStreamFromMemory(GetFileExtension(fileName), data, size);
+}
+
+Font LoadAssetFont(const char *fileName, int fontSize, int *codepoints, int codepointCount)
+{
+    int size = 0;
+    const unsigned char *data = GetAssetData(fileName, &size);
+    if (data == NULL) return LoadFontEx(fileName, fontSize, codepoints, codepointCount);
+
+    return LoadFontFromMemory(GetFileExtension(fileName), data, size, fontSize, codepoints, codepointCount);
+}
+
+// Memory mapping
+// ----------------------------------------------------------------------------
+
+static unsigned char *MapArchiveFile(const char *fileName, int *dataSize)
+{
+    *dataSize = 0;
+#if defined(PLATFORM_WEB)
+    if (!FileExists(fileName)) return NULL;
+    return LoadFileData(fileName, dataSize);
+#elif defined(_WIN32)
+    void *file = CreateFileA(fileName, WIN32_GENERIC_READ, WIN32_FILE_SHARE_READ, NULL, WIN32_OPEN_EXISTING, 0, NULL);
+    if (file == WIN32_INVALID_HANDLE) return NULL;
+
+    unsigned long size = GetFileSize(file, NULL);
+    void *mapping = (size > 0)? CreateFileMappingA(file, NULL, WIN32_PAGE_READONLY, 0, 0, NULL) : NULL;
+    void *data = (mapping != NULL)? MapViewOfFile(mapping, WIN32_FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mapping != NULL) CloseHandle(mapping); // The view keeps the mapping alive
+    CloseHandle(file);
+
+    if (data != NULL) *dataSize = (int)size;
+    return (unsigned char *)data;
+#else
+    int file = open(fileName, O_RDONLY);
+    if (file < 0) return NULL;
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if ((fstat(file, &info) == 0) && (info.st_size > 0))
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file); // The mapping stays valid
+
+    if (data == MAP_FAILED) return NULL;
+    madvise(data, (size_t)info.st_size, MADV_WILLNEED); // Everything in it is loaded at startup, read ahead
+    *dataSize = (int)info.st_size;
+    return (unsigned char *)data;
+#endif
+}
+
+static void UnmapArchiveFile(unsigned char *data, int dataSize)
+{
+#if defined(PLATFORM_WEB)
+    (void)dataSize;
+    UnloadFileData(data);
+#elif defined(_WIN32)
+    (void)dataSize;
+    UnmapViewOfFile(data);
+#else
+    munmap(data, (size_t)dataSize);
+#endif
+}
@@ -0,0 +1,171 @@
+// EXPLANATION:
+// Packs many small images into one texture (a sprite atlas)
+// See atlas.h for more documentation/descriptions
+
+#include "atlas.h"
+#include "archive.h"
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static bool PackShelves(const Image *images, const int *order, int count, int width, int height, Rectangle *regions);
+
+// Draw statistics
+static unsigned int lastTextureId;
+static int drawBatchCount;
+
+// Atlas
+// ----------------------------------------------------------------------------
+
+SpriteAtlas LoadSpriteAtlas(const char **fileNames, int count)
+{
+    Rectangle regions[ATLAS_MAX_SPRITES];
+    if (count > ATLAS_MAX_SPRITES) count = ATLAS_MAX_SPRITES;
+
+    Image packed = LoadAtlasImage(fileNames, count, regions);
+    SpriteAtlas atlas = LoadSpriteAtlasFromImage(packed, regions, count);
+    UnloadImage(packed);
+
+    return atlas;
+}
+
+SpriteAtlas LoadSpriteAtlasFromImage(Image packed, const Rectangle *regions, int count)
+{
+    SpriteAtlas atlas = { 0 };
+    if (count > ATLAS_MAX_SPRITES) count = ATLAS_MAX_SPRITES;
+
+    for (int i = 0; i < count; i++)
+        atlas.regions[i] = regions[i];
+    atlas.count = count;
+    atlas.texture = LoadTextureFromImage(packed);
+    SetTextureFilter(atlas.texture, TEXTURE_FILTER_BILINEAR);
+
+    return atlas;
+}
+
+void UnloadSpriteAtlas(SpriteAtlas atlas)
+{
+    UnloadTexture(atlas.texture);
+}
+
+Sprite GetAtlasSprite(SpriteAtlas atlas, int index)
+{
+    return (Sprite){ atlas.texture, atlas.regions[index] };
+}
+
+Image GenImageAtlas(const Image *images, int count, Rectangle *regions)
+{
+    // Tallest images first packs shelves with the least wasted space
+    int order[ATLAS_MAX_SPRITES];
+    for (int i = 0; i < count; i++)
+    {
+        int j = i;
+        for (; (j > 0) && (images[order[j - 1]].height < images[i].height); j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    // Grow the atlas until everything fits, keeping power-of-two sizes
+    int width = 256;
+    int height = 256;
+    while (!PackShelves(images, order, count, width, height, regions))
+    {
+        if ((width >= ATLAS_MAX_SIZE) && (height >= ATLAS_MAX_SIZE))
+        {
+            // The regions only hold the last failed try, nothing can be drawn from them
+            TraceLog(LOG_WARNING, "ATLAS: Images don't fit in %ix%i", ATLAS_MAX_SIZE, ATLAS_MAX_SIZE);
+            for (int i = 0; i < count; i++)
+                regions[i] = (Rectangle){ 0 };
+            return (Image){ 0 };
+        }
+        if (width <= height) width *= 2;
+        else height *= 2;
+    }
+
+    Image atlas = GenImageColor(width, height, BLANK);
+    for (int i = 0; i < count; i++)
+    {
+        Rectangle source = { 0, 0, (float)images[i].width, (float)images[i].height };
+        ImageDraw(&atlas, images[i], source, regions[i], WHITE);
+    }
+
+    TraceLog(LOG_INFO, "ATLAS: Packed %i images into %ix%i", count, width, height);
+    return atlas;
+}
+
+Image LoadAtlasImage(const char **fileNames, int count, Rectangle *regions)
+{
+    Image images[ATLAS_MAX_SPRITES] = { 0 };
+    if (count > ATLAS_MAX_SPRITES) count = ATLAS_MAX_SPRITES;
+
+    for (int i = 0; i < count; i++)
+        images[i] = LoadAssetImage(fileNames[i]);
+
+    Image packed = GenImageAtlas(images, count, regions);
+
+    for (int i = 0; i < count; i++)
+        UnloadImage(images[i]);
+
+    return packed;
+}
+
+// Simple shelf packing: fill rows left to right, start a new row when full
+static bool PackShelves(const Image *images, const int *order, int count, int width, int height, Rectangle *regions)
+{
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+
+    for (int k = 0; k < count; k++)
+    {
+        int i = order[k];
+        int paddedWidth  = images[i].width + 2*ATLAS_PADDING;
+        int paddedHeight = images[i].height + 2*ATLAS_PADDING;
+
+        if (x + paddedWidth > width) // next shelf
+        {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if ((paddedWidth > width) || (y + paddedHeight > height))
+            return false;
+
+        regions[i] = (Rectangle){
+            (float)(x + ATLAS_PADDING), (float)(y + ATLAS_PADDING),
+            (float)images[i].width, (float)images[i].height
+        };
+        x += paddedWidth;
+        if (paddedHeight > shelfHeight) shelfHeight = paddedHeight;
+    }
+
+    return true;
+}
+
+// Draw statistics
+// ----------------------------------------------------------------------------
+
+void ResetDrawStats(void)
+{
+    lastTextureId = 0;
+    drawBatchCount = 0;
+}
+
+void TrackDrawTexture(Texture texture)
+{
+    if (texture.id != lastTextureId)
+    {
+        lastTextureId = texture.id;
+        drawBatchCount++;
+    }
+}
+
+void TrackDrawCall(void)
+{
+    lastTextureId = 0; // Whatever's drawn next starts a new batch
+    drawBatchCount++;
+}
+
+int GetDrawBatchCount(void)
+{
+    return drawBatchCount;
+}
@@ -0,0 +1,253 @@
+// EXPLANATION:
+// Headless benchmark of the game simulation
+// Runs the same simulation steps as the game with scripted input, but with
+// no window, GL context or audio device, so it works on build machines
+// without a GPU. Run it from the repo directory so it finds the assets.
+//
+// Usage: SmashThePinata_bench [steps] [--replay <file>] [--wall <count>] [--workers <count>] [--assert-no-alloc]
+// With --replay, a recording made with the game's --record option drives the
+// simulation instead of the built-in script, for as many steps as it holds.
+// With --wall, the swings go through an arcade pinata wall of that many, a
+// replay always uses the wall it was recorded with.
+// With --workers, the job system gets that many worker threads instead of
+// one per core, 0 runs everything on the main thread.
+// With --assert-no-alloc, any heap allocation after the first
+// BENCH_WARMUP_STEPS steps fails the run (exit code 1), so a build machine
+// can catch allocations creeping back into the steady state.
+
+#include "raylib.h"
+
+#include "config.h"
+#include "game.h"
+#include "input.h"
+#include "particles.h"
+#include "profiler.h"
+#include "allocator.h"
+#include "archive.h"
+#include "jobs.h"
+#include "rope.h"
+#include "fracture.h"
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+
+#define BENCH_DEFAULT_STEPS 120000
+#define BENCH_SWING_PERIOD 600       // Steps between scripted swings
+#define BENCH_PARTICLES 100000       // Particles for the kernel throughput test
+#define BENCH_PARTICLE_STEPS 1000
+#define BENCH_ROPE_STEPS 1000        // Steps of every wall pinata's rope swinging at once
+#define BENCH_WARMUP_STEPS 1200      // Steps allowed to allocate with --assert-no-alloc
+
+// Game state, normally defined in main.c
+Camera2D camera;
+ScreenState currentScreen;
+float frameTime;
+float renderAlpha;
+double stepTime;
+bool gameShouldExit;
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void ScriptInput(int step);
+static void BenchParticleKernels(void);
+static void BenchRopes(void);
+
+int main(int argc, char **argv)
+{
+    int steps = BENCH_DEFAULT_STEPS;
+    const char *replayFile = NULL;
+    bool assertNoAlloc = false;
+    int workerCount = JOB_WORKERS_AUTO;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--replay") == 0) && (i + 1 < argc)) replayFile = argv[++i];
+        else if ((strcmp(argv[i], "--wall") == 0) && (i + 1 < argc)) pinataWallSize = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "--workers") == 0) && (i + 1 < argc)) workerCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--assert-no-alloc") == 0) assertNoAlloc = true;
+        else if (atoi(argv[i]) > 0) steps = atoi(argv[i]);
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    SetRandomSeed(1);
+    if ((replayFile != NULL) && !StartInputReplay(replayFile, &pinataWallSize)) // Replays with the wall it was recorded with
+    {
+        printf("Couldn't replay %s\n", replayFile);
+        return 1;
+    }
+
+    // The atlas is only packed for its sprite sizes, nothing is uploaded
+    OpenAssetArchive(ARCHIVE_FILE_NAME);
+    SpriteAtlas layout = { 0 };
+    Image packed = LoadAtlasImage(spriteFiles, SPRITE_COUNT, layout.regions);
+    if (layout.regions[SPRITE_PINATA].height <= 0)
+    {
+        printf("Couldn't load the sprites, run from the repo directory\n");
+        return 1;
+    }
+    UnloadImage(packed);
+    layout.count = SPRITE_COUNT;
+
+    // Made while the game loads, timed to show what stays off the steps
+    double fractureStart = GetProfilerTime();
+    pinataFracture = LoadFracturePattern(spriteFiles[SPRITE_PINATA], FRACTURE_PIECES);
+    double fractureTime = GetProfilerTime() - fractureStart;
+    CloseAssetArchive();
+
+    // As if the window were exactly the virtual size
+    Vector2 center = { VIRTUAL_WIDTH/2.0f, VIRTUAL_HEIGHT/2.0f };
+    camera = (Camera2D){ .offset = center, .target = center, .zoom = 1.0f };
+    input.screenScale = camera.zoom;
+    currentScreen = SCREEN_GAMEPLAY;
+    frameTime = 1.0f/SIMULATION_RATE;
+    InitArena(&frameArena, FRAME_ARENA_SIZE); // As InitGameState() does
+    InitArena(&stepArena, STEP_ARENA_SIZE);
+    InitArena(&persistentArena, PERSISTENT_ARENA_SIZE);
+    InitJobSystem(workerCount);
+    InitGameWorld(layout);
+
+    // Simulation
+    // ----------------------------------------------------------------------------
+    int hits = 0;
+    int bigSmashes = 0;
+    int firstAllocatingStep = -1;
+    unsigned long long steadyAllocations = 0; // After the warm-up
+    double slowestSmash = 0.0;                // Shattering a pinata must not stand out from other steps
+    AllocationStats allocsBefore = GetAllocationStats();
+    double start = GetProfilerTime();
+
+    int i = 0;
+    for (; (replayFile != NULL) || (i < steps); i++)
+    {
+        if (replayFile == NULL) ScriptInput(i);
+        else if (!BeginInputStep()) break; // Recording ran out
+        unsigned long long allocationCount = GetAllocationCount();
+        ResetArena(&frameArena);
+        double stepStart = GetProfilerTime();
+        StorePreviousState();
+        UpdateGameSimulation();
+        double stepDuration = GetProfilerTime() - stepStart;
+        if ((gameEvents & EVENT_BIG_SMASH) && (stepDuration > slowestSmash)) slowestSmash = stepDuration;
+        ConsumeGameInput();
+
+        unsigned long long stepAllocations = GetAllocationCount() - allocationCount;
+        if ((i >= BENCH_WARMUP_STEPS) && (stepAllocations > 0))
+        {
+            if (firstAllocatingStep < 0) firstAllocatingStep = i;
+            steadyAllocations += stepAllocations;
+        }
+
+        if (gameEvents & EVENT_HIT) hits++;
+        if (gameEvents & EVENT_BIG_SMASH) bigSmashes++;
+    }
+
+    double elapsed = GetProfilerTime() - start;
+    AllocationStats allocsAfter = GetAllocationStats();
+    steps = i;
+
+    printf("simulation: %i steps (%.1f s of game time) in %.3f s\n", steps, steps*frameTime, elapsed);
+    printf("  %.0f ns/step, %.0f steps/s\n", elapsed*1e9/steps, steps/elapsed);
+    printf("  %llu allocations, %llu frees during the run\n",
+           allocsAfter.allocations - allocsBefore.allocations, allocsAfter.frees - allocsBefore.frees);
+    printf("  %llu raylib allocations, %llu frees during the run\n",
+           allocsAfter.libraryAllocations - allocsBefore.libraryAllocations,
+           allocsAfter.libraryFrees - allocsBefore.libraryFrees);
+    printf("  %i hits, %i big smashes\n", hits, bigSmashes);
+    printf("  %i pinata pieces, made in %.2f ms while loading, slowest big smash step %.0f ns\n",
+           pinataFracture.count, fractureTime*1e3, slowestSmash*1e9);
+
+    FreeGameWorld();
+    FreeArena(&persistentArena);
+    FreeArena(&stepArena);
+    FreeArena(&frameArena);
+
+    if (assertNoAlloc && (firstAllocatingStep >= 0))
+    {
+        CloseJobSystem();
+        printf("FAILED: %llu allocations after the %i step warm-up, the first in step %i\n",
+               steadyAllocations, BENCH_WARMUP_STEPS, firstAllocatingStep);
+        return 1;
+    }
+
+    BenchParticleKernels();
+    BenchRopes();
+    CloseJobSystem();
+
+    return 0;
+}
+
+// Swing the hand across the pinata every BENCH_SWING_PERIOD steps, and swap
+// between hand and bat every few swings
+static void ScriptInput(int step)
+{
+    int phase = step%BENCH_SWING_PERIOD;
+    int swing = step/BENCH_SWING_PERIOD;
+
+    if (phase == 0)
+    {
+        input.grabPressed = true;
+        input.swapPressed = (swing%4 == 3);
+    }
+
+    if (phase < 120)      input.mousePosition = (Vector2){ VIRTUAL_WIDTH - 300.0f, VIRTUAL_HEIGHT/2.0f };
+    else if (phase < 200) input.mousePosition = (Vector2){ -2000.0f, VIRTUAL_HEIGHT/2.0f + 100.0f }; // hard enough to spill candy
+    else if (phase == 200) input.grabReleased = true;
+}
+
+// Throughput of every particle kernel this machine supports
+static void BenchParticleKernels(void)
+{
+    ParticleKernel best = GetBestParticleKernel();
+    printf("particles: %i particles, %i steps per kernel, %i job workers\n",
+           BENCH_PARTICLES, BENCH_PARTICLE_STEPS, GetJobWorkerCount());
+
+    for (int kernel = 0; kernel < PARTICLE_KERNEL_COUNT; kernel++)
+    {
+        if (!SetParticleKernel(kernel)) continue;
+
+        ParticleSystem particles;
+        InitParticles(&particles, BENCH_PARTICLES, NULL);
+        for (int i = 0; i < BENCH_PARTICLES; i++)
+        {
+            Vector2 position = { (float)(i%VIRTUAL_WIDTH), (float)(i%VIRTUAL_HEIGHT) };
+            Vector2 velocity = { (float)(i%1100 + 100), -(float)(i%900 + 100) };
+            EmitParticle(&particles, position, velocity, (float)(i%600 - 300), i%CANDY_SPRITES);
+        }
+
+        double start = GetProfilerTime();
+        for (int i = 0; i < BENCH_PARTICLE_STEPS; i++)
+            UpdateParticles(&particles, CANDY_GRAVITY, frameTime);
+        double elapsed = GetProfilerTime() - start;
+
+        printf("  %-8s %8.0f ns/step, %7.1f M particles/s%s\n", GetParticleKernelName(kernel),
+               elapsed*1e9/BENCH_PARTICLE_STEPS, (double)BENCH_PARTICLES*BENCH_PARTICLE_STEPS/elapsed/1e6,
+               (kernel == (int)best)? " (default)" : "");
+        FreeParticles(&particles);
+    }
+
+    SetParticleKernel(best);
+}
+
+// Worst case for the ropes: a whole wall of pinatas swinging at once
+static void BenchRopes(void)
+{
+    RopeSystem ropes;
+    if (!InitRopes(&ropes, PINATA_WALL_MAX, NULL)) return;
+    for (int i = 0; i < PINATA_WALL_MAX; i++)
+    {
+        Vector2 anchor = { (float)(i%32)*60.0f, (float)(i/32)*30.0f };
+        HangRope(&ropes, i, anchor, (Vector2){ anchor.x, anchor.y + 100.0f });
+        GetMutableRopePoints(&ropes, i)[ROPE_SEGMENTS].previous.x += (float)(i%50 + 10); // Pushed sideways
+    }
+
+    double start = GetProfilerTime();
+    for (int i = 0; i < BENCH_ROPE_STEPS; i++)
+        UpdateRopes(&ropes, NULL, PINATA_WALL_MAX, PINATA_GRAVITY, frameTime);
+    double elapsed = GetProfilerTime() - start;
+
+    printf("ropes: %i ropes of %i segments, %i iterations, %i steps\n",
+           PINATA_WALL_MAX, ROPE_SEGMENTS, ROPE_ITERATIONS, BENCH_ROPE_STEPS);
+    printf("  %8.0f ns/step, %5.1f ns per rope\n",
+           elapsed*1e9/BENCH_ROPE_STEPS, elapsed*1e9/BENCH_ROPE_STEPS/PINATA_WALL_MAX);
+    FreeRopes(&ropes);
+}
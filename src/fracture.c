@@ -0,0 +1,250 @@
+// EXPLANATION:
+// Breaks a sprite into pieces along a Voronoi pattern, for shattering pinatas
+// See fracture.h for more documentation/descriptions
+
+#include "fracture.h"
+#include "archive.h"
+#include "rlgl.h"
+#include "raymath.h"
+
+#include <stddef.h> // NULL
+#include <assert.h>
+
+#define FRACTURE_RANDOM_SEED 0x9e3779b9u // LoadFracturePattern() always makes the same pattern
+#define FRACTURE_SEED_TRIES 1000          // Random pixels tried for an opaque one, per candidate
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static unsigned int NextRandom(unsigned int *state);
+static bool PickOpaquePixel(const Color *pixels, int width, int height, unsigned int *state, Vector2 *pixel);
+static int ClipToCloser(const Vector2 *polygon, int count, Vector2 seed, Vector2 other, Vector2 *clipped);
+
+// Pattern
+// ----------------------------------------------------------------------------
+
+FracturePattern GenFracturePattern(Image image, int pieceCount, unsigned int seed)
+{
+    FracturePattern pattern = { 0 };
+    if (pieceCount > FRACTURE_PIECES) pieceCount = FRACTURE_PIECES;
+    if ((image.data == NULL) || (pieceCount < 1)) return pattern;
+
+    Color *pixels = LoadImageColors(image);
+    int width = image.width;
+    int height = image.height;
+
+    // Pieces are cut from the box around the opaque pixels
+    Vector2 min = { (float)width, (float)height };
+    Vector2 max = { 0.0f, 0.0f };
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (pixels[y*width + x].a < FRACTURE_ALPHA_THRESHOLD) continue;
+            min = Vector2Min(min, (Vector2){ (float)x, (float)y });
+            max = Vector2Max(max, (Vector2){ (float)(x + 1), (float)(y + 1) });
+        }
+    }
+    if ((min.x >= max.x) || (min.y >= max.y))
+    {
+        TraceLog(LOG_WARNING, "FRACTURE: Image has no opaque pixels to break");
+        UnloadImageColors(pixels);
+        return pattern;
+    }
+
+    // Seeds on opaque pixels, each the farthest of a few tries from the
+    // seeds before it, so pieces come out about the same size
+    Vector2 seeds[FRACTURE_PIECES];
+    int seedCount = 0;
+    unsigned int state = (seed != 0)? seed : 1;
+    while (seedCount < pieceCount)
+    {
+        Vector2 best = { 0 };
+        float bestDistance = -1.0f;
+        for (int i = 0; i < FRACTURE_SEED_CANDIDATES; i++)
+        {
+            Vector2 candidate;
+            if (!PickOpaquePixel(pixels, width, height, &state, &candidate)) continue;
+
+            float distance = (float)(width*width + height*height);
+            for (int j = 0; j < seedCount; j++)
+                distance = fminf(distance, Vector2DistanceSqr(candidate, seeds[j]));
+            if (distance > bestDistance)
+            {
+                best = candidate;
+                bestDistance = distance;
+            }
+        }
+        if (bestDistance <= 0.0f) break; // Only landed on taken pixels, the sprite is too small for more
+        seeds[seedCount++] = best;
+    }
+
+    // Every opaque pixel belongs to the piece of its closest seed, their
+    // middle is where the piece turns around
+    Vector2 sums[FRACTURE_PIECES] = { 0 };
+    int pixelCounts[FRACTURE_PIECES] = { 0 };
+    for (int y = (int)min.y; y < (int)max.y; y++)
+    {
+        for (int x = (int)min.x; x < (int)max.x; x++)
+        {
+            if (pixels[y*width + x].a < FRACTURE_ALPHA_THRESHOLD) continue;
+
+            Vector2 pixel = { x + 0.5f, y + 0.5f };
+            int closest = 0;
+            for (int i = 1; i < seedCount; i++)
+            {
+                if (Vector2DistanceSqr(pixel, seeds[i]) < Vector2DistanceSqr(pixel, seeds[closest]))
+                    closest = i;
+            }
+            sums[closest] = Vector2Add(sums[closest], pixel);
+            pixelCounts[closest]++;
+        }
+    }
+
+    // Each piece is what's left of the box after cutting away everything
+    // closer to another seed
+    for (int i = 0; i < seedCount; i++)
+    {
+        Vector2 polygon[FRACTURE_MAX_VERTICES] = {
+            { min.x, min.y }, { min.x, max.y }, { max.x, max.y }, { max.x, min.y }, // As DrawTexturePro() winds
+        };
+        int count = 4;
+        for (int j = 0; (j < seedCount) && (count >= 3); j++)
+        {
+            if (j == i) continue;
+            Vector2 clipped[FRACTURE_MAX_VERTICES];
+            count = ClipToCloser(polygon, count, seeds[i], seeds[j], clipped);
+            for (int k = 0; k < count; k++)
+                polygon[k] = clipped[k];
+        }
+        if (count < 3) continue;
+
+        FracturePiece *piece = &pattern.pieces[pattern.count++];
+        piece->vertexCount = count;
+        for (int k = 0; k < count; k++)
+            piece->vertices[k] = (Vector2){ polygon[k].x/width, polygon[k].y/height };
+
+        Vector2 center = (pixelCounts[i] > 0)? Vector2Scale(sums[i], 1.0f/pixelCounts[i]) : seeds[i];
+        piece->center = (Vector2){ center.x/width, center.y/height };
+    }
+
+    UnloadImageColors(pixels);
+    TraceLog(LOG_INFO, "FRACTURE: Broke %ix%i image into %i pieces", width, height, pattern.count);
+    return pattern;
+}
+
+FracturePattern LoadFracturePattern(const char *fileName, int pieceCount)
+{
+    Image image = LoadAssetImage(fileName);
+    FracturePattern pattern = GenFracturePattern(image, pieceCount, FRACTURE_RANDOM_SEED);
+    UnloadImage(image);
+
+    return pattern;
+}
+
+// xorshift32, a random sequence of its own that doesn't disturb raylib's,
+// and is safe on the loader thread
+static unsigned int NextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static bool PickOpaquePixel(const Color *pixels, int width, int height, unsigned int *state, Vector2 *pixel)
+{
+    for (int i = 0; i < FRACTURE_SEED_TRIES; i++)
+    {
+        int x = (int)(NextRandom(state)%(unsigned int)width);
+        int y = (int)(NextRandom(state)%(unsigned int)height);
+        if (pixels[y*width + x].a >= FRACTURE_ALPHA_THRESHOLD)
+        {
+            *pixel = (Vector2){ x + 0.5f, y + 0.5f };
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Keep the part of a convex polygon closer to seed than to other (one
+// Sutherland-Hodgman step against their bisector), returns the vertex count
+static int ClipToCloser(const Vector2 *polygon, int count, Vector2 seed, Vector2 other, Vector2 *clipped)
+{
+    Vector2 normal = Vector2Subtract(other, seed);
+    float limit = Vector2DotProduct(normal, Vector2Lerp(seed, other, 0.5f));
+    int clippedCount = 0;
+    assert(count < FRACTURE_MAX_VERTICES); // Room for the vertex a cut can add (see FRACTURE_MAX_VERTICES)
+
+    for (int i = 0; i < count; i++)
+    {
+        Vector2 a = polygon[i];
+        Vector2 b = polygon[(i + 1)%count];
+        float distanceA = Vector2DotProduct(normal, a) - limit; // Negative on the seed's side
+        float distanceB = Vector2DotProduct(normal, b) - limit;
+
+        if (distanceA <= 0.0f) clipped[clippedCount++] = a;
+        if (((distanceA < 0.0f) && (distanceB > 0.0f)) || ((distanceA > 0.0f) && (distanceB < 0.0f)))
+            clipped[clippedCount++] = Vector2Lerp(a, b, distanceA/(distanceA - distanceB)); // Where the edge crosses
+    }
+
+    assert(clippedCount <= count + 1); // A line crosses a convex polygon's outline at most twice
+    return clippedCount;
+}
+
+// Draw
+// ----------------------------------------------------------------------------
+
+void DrawFragments(Sprite sprite, const FracturePattern *pattern, const FragmentInstance *fragments, int count, Vector2 size)
+{
+    if (count <= 0) return;
+
+    // Same texture and quads as DrawTexturePro(), so the pieces join the
+    // sprites' batch. A convex polygon is a fan of quads from its first
+    // vertex, the last one repeats a vertex when the count is odd.
+    TrackDrawTexture(sprite.texture);
+    Vector2 texel = { 1.0f/sprite.texture.width, 1.0f/sprite.texture.height };
+    rlSetTexture(sprite.texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+
+    for (int i = 0; i < count; i++)
+    {
+        const FragmentInstance *fragment = &fragments[i];
+        const FracturePiece *piece = &pattern->pieces[fragment->piece];
+        float cosAngle = cosf(fragment->angle*DEG2RAD);
+        float sinAngle = sinf(fragment->angle*DEG2RAD);
+
+        // Corners in the world, and where they are in the atlas
+        Vector2 positions[FRACTURE_MAX_VERTICES];
+        Vector2 texcoords[FRACTURE_MAX_VERTICES];
+        for (int j = 0; j < piece->vertexCount; j++)
+        {
+            Vector2 local = Vector2Multiply(Vector2Subtract(piece->vertices[j], piece->center), size);
+            positions[j] = (Vector2){
+                fragment->position.x + local.x*cosAngle - local.y*sinAngle,
+                fragment->position.y + local.x*sinAngle + local.y*cosAngle,
+            };
+            texcoords[j] = (Vector2){
+                (sprite.source.x + piece->vertices[j].x*sprite.source.width)*texel.x,
+                (sprite.source.y + piece->vertices[j].y*sprite.source.height)*texel.y,
+            };
+        }
+
+        for (int j = 1; j + 1 < piece->vertexCount; j += 2)
+        {
+            int quad[4] = { 0, j, j + 1, (j + 2 < piece->vertexCount)? j + 2 : j + 1 };
+            for (int k = 0; k < 4; k++)
+            {
+                rlTexCoord2f(texcoords[quad[k]].x, texcoords[quad[k]].y);
+                rlVertex2f(positions[quad[k]].x, positions[quad[k]].y);
+            }
+        }
+    }
+
+    rlEnd();
+    rlSetTexture(0);
+}
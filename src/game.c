@@ -4,24 +4,89 @@
 #include "game.h"
 #include "raymath.h"
 #include "config.h"
+#include "input.h"
+#include "particles.h"
+#include "profiler.h"
+#include "allocator.h"
+#include "archive.h"
+#include "loader.h"
+#include "text.h"
+#include "synth.h"
+#include "grid.h"
+#include "instancing.h"
+#include "jobs.h"
+#include "rope.h"
+#include "fracture.h"
+
+#include <stdio.h> // snprintf
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void InitPinatas(Sprite sprite);
+static void HangPinata(int index);
+static void FollowRope(int index);
+static void HitPinata(int index, float timeOfImpact);
+static void ShatterPinata(int index, Vector2 velocity);
+static Vector2 GetHitPosition(Vector2 handPosition, float batAngle);
+static int GetSweepPieces(float fromAngle, float *angleDelta);
+static Rectangle GetSweepBounds(Vector2 fromPosition, float fromAngle);
+static bool SweepHitPosition(const EntityPinata *pinata, Vector2 fromPosition, float fromAngle, float *timeOfImpact);
+static void SweepCandidates(void *data, int start, int end);
+static const char *GetScoreText(float score);
+
+// Candidates swept per job, a handful of sweeps is too little work to hand off
+#define SWEEP_JOB_SIZE 32
+
+// One step's swing against the pinatas the grid found, see SweepCandidates()
+typedef struct SweepJob {
+    const int *candidates;
+    float *timesOfImpact; // Per candidate, negative when missed
+    Vector2 fromPosition;
+    float fromAngle;
+} SweepJob;
 
 // Game globals
 GameMode currentMode           = { 0 };
-EntityPinata pinata            = { 0 };
+EntityPinata *pinatas          = NULL; // Pool in the persistent arena
+int pinataCount;
+int pinataWallSize;
+int *smashedPinatas;                   // Indices of the pinatas that are smashed, only these move
+int smashedCount;
+SpatialGrid pinataGrid;                // Pinatas where they hang, smashed ones are skipped when found
+RopeSystem ropes;                      // One per pinata, it hangs from the rope's end
+float swingCenterX;                    // The bat's angle follows the hand's distance from here
 EntityHand hand                = { 0 };
 EntityBat bat                  = { 0 };
-Candy candy[CANDY_AMOUNT] = { 0 };
-Texture candyTexture[8];
+ParticleSystem candy           = { 0 };
+ParticleSystem fragments       = { 0 }; // Pieces of shattered pinatas, the texture id is the piece
+FracturePattern pinataFracture;
+SpriteAtlas atlas;
+Sprite candySprite[CANDY_SPRITES];
 Font textFont;
+Shader textShader; // Draws textFont, which is a signed distance field, unless it failed to load
 Music musicBackground;
 Music musicWin;
-Sound soundWhoosh;
+Wave waveHit;  // Handed to the synth once loaded
+Wave waveBonk;
 Vector2 mousePos;
 float timer;
 float score;
 float speed;
 float maxSpeed;
 bool showHint;
+unsigned int gameEvents;
+bool gameLoaded;
+double loadStartTime;
+
+// Sprite files packed into the atlas, in SpriteId order
+const char *spriteFiles[SPRITE_COUNT] = {
+    [SPRITE_PINATA]      = "assets/pinata.png",
+    [SPRITE_BAT]         = "assets/bat.png",
+    [SPRITE_HAND_OPEN]   = "assets/hand_open.png",
+    [SPRITE_HAND_CLOSED] = "assets/hand_closed.png",
+    "assets/candy1.png", "assets/candy2.png", "assets/candy3.png", "assets/candy4.png",
+    "assets/candy5.png", "assets/candy6.png", "assets/candy7.png", "assets/candy8.png",
+};
 
 // Initialization
 // ----------------------------------------------------------------------------
@@ -29,31 +94,74 @@ bool showHint;
 void InitGameState(void)
 {
     currentScreen = SCREEN_LOGO;
-    currentMode   = MODE_BAT;
     camera.target = (Vector2){ VIRTUAL_WIDTH/2, VIRTUAL_HEIGHT/2 };
+    InitArena(&frameArena, FRAME_ARENA_SIZE);
+    InitArena(&stepArena, STEP_ARENA_SIZE);
+    InitArena(&persistentArena, PERSISTENT_ARENA_SIZE);
+    InitJobSystem(JOB_WORKERS_AUTO);
+
+    // Assets come from the packed archive when there is one, and load in
+    // the background while the logo plays (see UpdateGameLoading)
+    loadStartTime = GetProfilerTime();
+    OpenAssetArchive(ARCHIVE_FILE_NAME);
+    LoadGameAssets();
+    StartAssetLoading();
+}
+
+void LoadGameAssets(void)
+{
+    QueueFontLoad(&textFont, "assets/TheVisitor.ttf", TEXT_SDF_FONT_SIZE, FONT_SDF);
+    QueueMusicLoad(&musicBackground, "assets/music_background.wav");
+    QueueMusicLoad(&musicWin, "assets/music_highscore.qoa");
+    QueueWaveLoad(&waveHit, "assets/hit.qoa");
+    QueueWaveLoad(&waveBonk, "assets/bonk.qoa");
+
+    // All sprites share one texture, so they draw in a single batch
+    QueueAtlasLoad(&atlas, spriteFiles, SPRITE_COUNT);
+
+    // How the pinata breaks is worked out once, not on every big smash
+    QueueFractureLoad(&pinataFracture, spriteFiles[SPRITE_PINATA], FRACTURE_PIECES);
+}
+
+bool UpdateGameLoading(void)
+{
+    if (gameLoaded) return true;
+    if (!UpdateAssetLoading()) return false;
+
+    TraceLog(LOG_INFO, "GAME: Loaded assets in %.1f ms (%s)", (GetProfilerTime() - loadStartTime)*1000.0,
+             IsAssetArchiveOpen()? ARCHIVE_FILE_NAME : "loose files");
+    if (textFont.texture.id != GetFontDefault().texture.id) // Falls back to the default font, which isn't an SDF
+    {
+        SetTextureFilter(textFont.texture, TEXTURE_FILTER_BILINEAR);
+        textShader = LoadSdfShader();
+    }
+    InitSpriteInstancing();
+    InitGameWorld(atlas);
+    PlayMusicStream(musicBackground);
+    LoadSynthSample(SYNTH_SAMPLE_HIT, waveHit);
+    LoadSynthSample(SYNTH_SAMPLE_BONK, waveBonk);
+    waveHit = waveBonk = (Wave){ 0 };
+    StartSynth();
+    gameLoaded = true;
+
+    return true;
+}
+
+void InitGameWorld(SpriteAtlas spriteAtlas)
+{
+    currentMode = MODE_BAT;
 
-    // Load Assets
-    textFont = LoadFontEx("assets/TheVisitor.ttf", 100, 0, 0);
-    SetTextureFilter(textFont.texture, TEXTURE_FILTER_BILINEAR);
-    musicBackground   = LoadMusicStream("assets/music_background.wav");
-    musicWin          = LoadMusicStream("assets/music_highscore.wav");
-    soundWhoosh       = LoadSound("assets/whoosh.wav");
-    pinata.sprite     = LoadFilteredTexture("assets/pinata.png");
-    pinata.soundHit   = LoadSound("assets/hit.wav");
-    bat.sprite        = LoadFilteredTexture("assets/bat.png");
-    bat.soundHit      = LoadSound("assets/bonk.wav");
-    hand.spriteOpen   = LoadFilteredTexture("assets/hand_open.png");
-    hand.spriteClosed = LoadFilteredTexture("assets/hand_closed.png");
-    for (unsigned int i = 0; i < 8; i++)
-        candyTexture[i] = LoadFilteredTexture((char *)TextFormat("assets/candy%i.png", i + 1));
-
-    // Pinata
-    pinata.rect.height = 800;
-    pinata.rect.width  = pinata.rect.height*((float)pinata.sprite.width/pinata.sprite.height);
-    pinata.rect.x      = pinata.rect.width;
-    pinata.rect.y      = pinata.rect.height*(2.0f/3.0f);
-    pinata.startPos    = (Vector2){ pinata.rect.x, pinata.rect.y };
-    pinata.origin      = (Vector2){ pinata.rect.width/2.0f, pinata.rect.height/2.0f };
+    bat.sprite        = GetAtlasSprite(spriteAtlas, SPRITE_BAT);
+    hand.spriteOpen   = GetAtlasSprite(spriteAtlas, SPRITE_HAND_OPEN);
+    hand.spriteClosed = GetAtlasSprite(spriteAtlas, SPRITE_HAND_CLOSED);
+    for (unsigned int i = 0; i < CANDY_SPRITES; i++)
+        candySprite[i] = GetAtlasSprite(spriteAtlas, SPRITE_CANDY + i);
+
+    // Level data lives in the persistent arena, built from scratch each time
+    ResetArena(&persistentArena);
+    InitParticles(&candy, CANDY_CAPACITY, &persistentArena);
+    InitParticles(&fragments, FRAGMENT_CAPACITY, &persistentArena);
+    InitPinatas(GetAtlasSprite(spriteAtlas, SPRITE_PINATA));
 
     // Hand
     hand.startAngle = 90.0f;
@@ -67,34 +175,97 @@ void InitGameState(void)
 
     // Bat
     bat.rect.height = 800;
-    bat.rect.width  = bat.rect.height*((float)bat.sprite.width/bat.sprite.height);
+    bat.rect.width  = bat.rect.height*(bat.sprite.source.width/bat.sprite.source.height);
     bat.origin = (Vector2){ bat.rect.width/2.0f, bat.rect.height - bat.rect.height/6.0f };
 
+    StorePreviousState();
     showHint = true;
-    PlayMusicStream(musicBackground);
+}
+
+// One big pinata, or the wall: rows of small ones filling the left of the screen
+static void InitPinatas(Sprite sprite)
+{
+    int count = (pinataWallSize > 0)? pinataWallSize : 1;
+    if (count > PINATA_WALL_MAX) count = PINATA_WALL_MAX;
+
+    pinatas = ArenaAlloc(&persistentArena, (size_t)count*sizeof(EntityPinata));
+    smashedPinatas = ArenaAlloc(&persistentArena, (size_t)count*sizeof(int));
+    Rectangle *bounds = ArenaAlloc(&frameArena, (size_t)count*sizeof(Rectangle));
+    bool ropesReady = InitRopes(&ropes, count, &persistentArena);
+    pinataCount = ((pinatas != NULL) && (smashedPinatas != NULL) && (bounds != NULL) && ropesReady)? count : 0;
+    smashedCount = 0;
+
+    float aspect = sprite.source.width/sprite.source.height;
+    float height = 800;
+    int columns = 1;
+    if (pinataWallSize > 0)
+    {
+        // Shrink the pinatas until enough rows and columns fit
+        float wallWidth = VIRTUAL_WIDTH*PINATA_WALL_WIDTH;
+        height = sqrtf(wallWidth*VIRTUAL_HEIGHT/(pinataCount*aspect));
+        while ((int)(wallWidth/(height*aspect))*(int)(VIRTUAL_HEIGHT/height) < pinataCount)
+            height *= 0.95f;
+        columns = (int)(wallWidth/(height*aspect));
+    }
+
+    for (int i = 0; i < pinataCount; i++)
+    {
+        EntityPinata *pinata = &pinatas[i];
+        pinata->sprite      = sprite;
+        pinata->rect.height = height;
+        pinata->rect.width  = pinata->rect.height*aspect;
+        if (pinataWallSize > 0)
+        {
+            pinata->rect.x = (i%columns + 0.5f)*pinata->rect.width;
+            pinata->rect.y = (i/columns + 0.5f)*pinata->rect.height;
+        }
+        else
+        {
+            pinata->rect.x = pinata->rect.width; // Where swingCenterX is
+            pinata->rect.y = pinata->rect.height*(2.0f/3.0f);
+        }
+        pinata->startPos = (Vector2){ pinata->rect.x, pinata->rect.y };
+        pinata->origin   = (Vector2){ pinata->rect.width/2.0f, pinata->rect.height/2.0f };
+        HangPinata(i);
+
+        // Anywhere it can turn to while it hangs there
+        float reach = Vector2Length(pinata->origin);
+        bounds[i] = (Rectangle){ pinata->rect.x - reach, pinata->rect.y - reach, 2.0f*reach, 2.0f*reach };
+    }
+
+    swingCenterX = (pinataWallSize > 0)? VIRTUAL_WIDTH*PINATA_WALL_WIDTH/2.0f : height*aspect;
+
+    // Cells about a pinata across, so a swing only finds its neighbours
+    if (!BuildSpatialGrid(&pinataGrid, bounds, pinataCount, 2.0f*Vector2Length((Vector2){ height*aspect/2.0f, height/2.0f }), &persistentArena))
+        TraceLog(LOG_WARNING, "GAME: No room for the pinatas' grid, nothing can be hit");
+}
+
+void FreeGameWorld(void)
+{
+    FreeParticles(&candy);
+    FreeParticles(&fragments);
+    ResetArena(&persistentArena);
 }
 
 void FreeGameState(void)
 {
+    StopAssetLoading(); // In case the game closes before loading finished
     UnloadFont(textFont);
+    if (textShader.id > 0) UnloadShader(textShader);
+    UnloadSpriteInstancing();
+    ClearTextCache();
     UnloadMusicStream(musicBackground);
     UnloadMusicStream(musicWin);
-    UnloadSound(soundWhoosh);
-    UnloadTexture(pinata.sprite);
-    UnloadSound(pinata.soundHit);
-    UnloadTexture(bat.sprite);
-    UnloadSound(bat.soundHit);
-    UnloadTexture(hand.spriteOpen);
-    UnloadTexture(hand.spriteClosed);
-    for (unsigned int i = 0; i < 8; i++)
-        UnloadTexture(candyTexture[i]);
-}
-
-Texture LoadFilteredTexture(char* path)
-{
-    Texture tex = LoadTexture(path);
-    SetTextureFilter(tex, TEXTURE_FILTER_BILINEAR);
-    return tex;
+    StopSynth();
+    UnloadWave(waveHit); // Only still here if loading never finished
+    UnloadWave(waveBonk);
+    UnloadSpriteAtlas(atlas);
+    CloseAssetArchive(); // After the music streams, they read from it
+    FreeGameWorld();
+    FreeArena(&persistentArena);
+    FreeArena(&stepArena);
+    FreeArena(&frameArena);
+    CloseJobSystem(); // After the loader thread, it hands out jobs
 }
 
 // Update
@@ -102,23 +273,27 @@ Texture LoadFilteredTexture(char* path)
 
 void UpdateGameFrame(void)
 {
-    UpdateMusicStream(musicBackground);
-    UpdateMusicStream(musicWin);
-    if (!IsSoundPlaying(soundWhoosh))
-        PlaySound(soundWhoosh);
+    StorePreviousState();
+    UpdateGameSimulation();
+    UpdateGameAudio();
+}
 
+void UpdateGameSimulation(void)
+{
+    ResetArena(&stepArena); // Last step's scratch is done with
+    gameEvents = EVENT_NONE;
     timer -= frameTime;
-    mousePos = GetScreenToWorld2D(GetMousePosition(), camera);
+    mousePos = input.mousePosition;
 
     // Mode swap
     // ----------------------------------------------------------------------------
-    if (IsKeyPressed(KEY_SPACE))
+    if (input.swapPressed)
     {
         if (currentMode == MODE_HAND)
         {
             currentMode = MODE_BAT;
             hand.startPos.y += 200.0f;
-            hand.angle = (hand.position.x - pinata.startPos.x)*0.1f + 30.0f;
+            hand.angle = (hand.position.x - swingCenterX)*0.1f + 30.0f;
         }
         else
         {
@@ -129,25 +304,27 @@ void UpdateGameFrame(void)
 
     // Grab or Release Hand
     // ----------------------------------------------------------------------------
-    if (!hand.grabbed && IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+    if (!hand.grabbed && input.grabPressed)
     {
         hand.grabbed = true;
         showHint = false;
     }
 
-    if (hand.grabbed && IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
+    if (hand.grabbed && input.grabReleased)
     {
         hand.grabbed = false;
         speed = 0;
         maxSpeed = 0;
     }
 
+    Vector2 stepStartPosition = hand.position;
+    float stepStartAngle = bat.angle;
     if (hand.grabbed)
     {
         Vector2 prevPos = hand.position;
         Vector2 newPos = Vector2Lerp(hand.position, mousePos, 25.0f*frameTime);
         hand.velocity = Vector2Subtract(newPos, prevPos);
-        speed = Vector2Length(hand.velocity)*camera.zoom/frameTime*0.01f;
+        speed = Vector2Length(hand.velocity)*input.screenScale/frameTime*0.01f;
 #if defined(PLATFORM_WEB) // web canvas scales differently
         speed *= 1.5f;
 #endif
@@ -160,7 +337,7 @@ void UpdateGameFrame(void)
         }
         else // if (currentMode == MODE_BAT)
         {
-            newAngle = (hand.position.x - pinata.startPos.x)*0.1f + 30.0f;
+            newAngle = (hand.position.x - swingCenterX)*0.1f + 30.0f;
         }
         float angleDelta = newAngle - hand.angle;
         if (angleDelta > 180.0f) angleDelta -= 360.0f;
@@ -171,7 +348,7 @@ void UpdateGameFrame(void)
             if (hand.angle < 0.0f) hand.angle += 360.0f;
         }
 
-        if (!pinata.smashed && (speed > maxSpeed))
+        if ((smashedCount == 0) && (speed > maxSpeed))
             maxSpeed = speed;
 
         hand.position = newPos;
@@ -188,108 +365,305 @@ void UpdateGameFrame(void)
         if (hand.angle < 0.0f) hand.angle += 360.0f;
     }
 
-    if (currentMode == MODE_BAT)
+    // Bat follows the hand in both modes, so it never pops in from a stale
+    // position when swapping modes
+    bat.rect.x = hand.position.x;
+    bat.rect.y = hand.position.y;
+    bat.angle = hand.angle - 90.0f;
+
+    // Hit pinatas at minimum velocity
+    // ----------------------------------------------------------------------------
+    // The hit is swept from where the hand/bat was at the start of the step,
+    // so a fast swing can't pass through a pinata between two steps. Only the
+    // pinatas the grid finds near the swing are tested.
+    int firstHit = smashedCount; // Pinatas hit now go after the ones already smashed
+    if (hand.grabbed && (speed > 50.0f) && (hand.velocity.x < 0))
     {
-        bat.rect.x = hand.position.x;
-        bat.rect.y = hand.position.y;
-        bat.angle = hand.angle - 90.0f;
+        Rectangle sweepBounds = GetSweepBounds(stepStartPosition, stepStartAngle);
+        int *candidates = ArenaAlloc(&stepArena, (size_t)pinataCount*sizeof(int));
+        int candidateCount = (candidates != NULL)? QuerySpatialGrid(&pinataGrid, sweepBounds, candidates, pinataCount) : 0;
+        float *timesOfImpact = ArenaAlloc(&stepArena, (size_t)candidateCount*sizeof(float));
+        if (timesOfImpact == NULL) candidateCount = 0;
+
+        // Sweeps only read, so they run on any thread, then the hits are
+        // applied here in candidate order, same as on a single thread
+        SweepJob sweep = { candidates, timesOfImpact, stepStartPosition, stepStartAngle };
+        ParallelFor(candidateCount, SWEEP_JOB_SIZE, SweepCandidates, &sweep);
+        for (int i = 0; i < candidateCount; i++)
+        {
+            if (timesOfImpact[i] >= 0.0f) HitPinata(candidates[i], timesOfImpact[i]);
+        }
     }
 
-    static float whooshVolume = 0.0f;
-    static float whooshPitch = 1.0f;
-    float pitchMin = (currentMode == MODE_HAND)? 2.5f : 1.0f;
-    float targetVolume = (speed < 15)? 0 : Remap(speed, 15, 100.0f, 0, 1.0f);
-    float targetPitch = Remap(speed, 0, 200.0f, pitchMin, pitchMin*4);
-    whooshVolume = Lerp(whooshVolume, targetVolume, 5.0f*frameTime);
-    whooshPitch  = Lerp(whooshPitch, targetPitch, 5.0f*frameTime);
-    SetSoundVolume(soundWhoosh, whooshVolume);
-    SetSoundPitch(soundWhoosh, whooshPitch);
-
-    // Hit pinata at minimum velocity
+    // Smashed pinatas swing on their ropes, and are put back when their time is up
+    // ----------------------------------------------------------------------------
+    // Only their ropes move, the others hang still. Backwards over the ones
+    // smashed before this step, whichever is swapped in for a removed one
+    // has been moved already, or was only just hit
+    UpdateRopes(&ropes, smashedPinatas, firstHit, PINATA_GRAVITY, frameTime);
+    for (int i = firstHit - 1; i >= 0; i--)
+    {
+        int index = smashedPinatas[i];
+        EntityPinata *pinata = &pinatas[index];
+        FollowRope(index);
+        pinata->resetTimer -= frameTime;
+        if ((pinata->resetTimer < 0) && (pinata->piecesFlying == 0))
+        {
+            pinata->smashed = false;
+            HangPinata(index);
+            smashedPinatas[i] = smashedPinatas[--smashedCount];
+
+            if (smashedCount == 0)
+            {
+                maxSpeed = 0;
+                score = 0;
+                gameEvents |= EVENT_RESET;
+            }
+        }
+    }
+
+    // Update Candy and pinata pieces
     // ----------------------------------------------------------------------------
-    Vector2 origin = { pinata.rect.width/2, pinata.rect.height/2 };
-    Vector2 hitPosition = hand.position;
-    if (currentMode == MODE_BAT) // set hitPosition at center of bat
+    // Both are gone once they fall off the bottom of the screen
+    UpdateParticles(&candy, CANDY_GRAVITY, frameTime);
+    RemoveParticlesBelow(&candy, VIRTUAL_HEIGHT + 2.0f*CANDY_RADIUS); // Clear of it however it turns
+    UpdateParticles(&fragments, PINATA_GRAVITY, frameTime);
+    float pieceReach = (pinataCount > 0)? fmaxf(pinatas[0].rect.width, pinatas[0].rect.height) : 0.0f; // From its center
+    if (RemoveParticlesBelow(&fragments, VIRTUAL_HEIGHT + pieceReach) > 0)
     {
-        Vector2 hitOffset = { 0, bat.origin.y/2 };
-        Vector2 batHandle = { bat.rect.x, bat.rect.y };
-        hitOffset = Vector2Rotate(hitOffset, bat.angle*DEG2RAD);
-        hitPosition = Vector2Subtract(batHandle, hitOffset);
+        // Count what's left of each shattered pinata
+        for (int i = 0; i < smashedCount; i++)
+            pinatas[smashedPinatas[i]].piecesFlying = 0;
+        for (int i = 0; i < fragments.count; i++)
+            pinatas[fragments.source[i]].piecesFlying++;
     }
-    if (!pinata.smashed && hand.grabbed && (speed > 50.0f) && (hand.velocity.x < 0) &&
-        CheckCollisionCircleRecRotated(hitPosition, hand.radius, pinata.rect, origin, pinata.angle))
+}
+
+void UpdateGameAudio(void)
+{
+    PROFILE_BEGIN(ZONE_MUSIC);
+    UpdateMusicStream(musicBackground);
+    UpdateMusicStream(musicWin);
+    PROFILE_END(ZONE_MUSIC);
+
+    // Whoosh and hit sounds are mixed by the synth, at this step's time (see synth.h)
+    float pitchMin = (currentMode == MODE_HAND)? 2.5f : 1.0f;
+    float whooshVolume = (speed < 15)? 0 : Remap(speed, 15, 100.0f, 0, 1.0f);
+    float whooshPitch = Remap(speed, 0, 200.0f, pitchMin, pitchMin*4);
+    SetWhoosh(whooshVolume, whooshPitch, stepTime);
+
+    if (gameEvents & EVENT_HIT)
     {
-        score = speed;
-        pinata.smashed = true;
-        pinata.spinRate = -speed*0.03f;
-        pinata.xVelocity = score*0.1f;
-        if (score > 200.0f)
+        if (gameEvents & EVENT_BIG_SMASH)
         {
-            timer = 3.0f;
-            pinata.spinRate *= 1.5f;
-            pinata.xVelocity *= 0.3f;
-            SpawnCandy();
             PlayMusicStream(musicWin);
-            if (currentMode == MODE_BAT) PlaySound(bat.soundHit);
-
+            if (currentMode == MODE_BAT) PlaySynthSample(SYNTH_SAMPLE_BONK, 1.0f, stepTime);
         }
-        else timer = 1.0f;
-
         PauseMusicStream(musicBackground);
-        PlaySound(pinata.soundHit);
+        PlaySynthSample(SYNTH_SAMPLE_HIT, 1.0f, stepTime);
     }
 
-    if (pinata.smashed)
+    if (gameEvents & EVENT_RESET)
     {
-        pinata.rect.x -= pinata.xVelocity;
-        pinata.angle += pinata.spinRate;
+        StopMusicStream(musicWin);
+        PlayMusicStream(musicBackground);
     }
+}
 
-    // Reset after pinata smashed
-    // ----------------------------------------------------------------------------
-    if (pinata.smashed && (timer < 0))
+static void HitPinata(int index, float timeOfImpact)
+{
+    EntityPinata *pinata = &pinatas[index];
+    score = speed;
+    pinata->smashed = true;
+    float push = score*PINATA_HIT_PUSH;
+    bool bigSmash = (score > 200.0f);
+    gameEvents |= EVENT_HIT;
+    if (bigSmash)
     {
-        pinata.smashed = false;
-        pinata.rect.x = pinata.startPos.x;
-        pinata.angle = 0;
-        maxSpeed = 0;
-        score = 0;
-        StopMusicStream(musicWin);
-        PlayMusicStream(musicBackground);
+        timer = 3.0f;
+        push *= 1.5f;
+        SpawnCandy(pinata);
+        gameEvents |= EVENT_BIG_SMASH;
     }
+    else timer = 1.0f;
+    pinata->resetTimer = timer;
+
+    // Pushed the way the swing goes, the rope's end gets the velocity, and
+    // only moves for the part of the step after the impact
+    Vector2 pushVelocity = Vector2Scale(Vector2Normalize(hand.velocity), push);
+    Vector2 stepVelocity = Vector2Scale(pushVelocity, frameTime);
+    if (bigSmash) ShatterPinata(index, Vector2Scale(pushVelocity, FRAGMENT_PUSH)); // From where it was hit
+    RopePoint *end = &GetMutableRopePoints(&ropes, index)[ROPE_SEGMENTS];
+    end->position = Vector2Add(end->position, Vector2Scale(stepVelocity, 1.0f - timeOfImpact));
+    end->previous = Vector2Subtract(end->position, stepVelocity);
+    FollowRope(index);
+    smashedPinatas[smashedCount++] = index;
+}
 
-    // Update Candy
-    // ----------------------------------------------------------------------------
-    if (pinata.smashed)
+// Swaps the pinata for the pieces of its fracture pattern, each starting
+// where it is in the sprite and flying apart from the middle. Only copies
+// the pattern, so a smash costs no more than a few particles.
+static void ShatterPinata(int index, Vector2 velocity)
+{
+    EntityPinata *pinata = &pinatas[index];
+    if ((pinataFracture.count == 0) || (fragments.count + pinataFracture.count > fragments.capacity))
+        return; // No room for the pieces, it swings whole instead
+
+    Vector2 size = { pinata->rect.width, pinata->rect.height };
+    Vector2 pivot = { pinata->rect.x, pinata->rect.y };
+    for (int i = 0; i < pinataFracture.count; i++)
     {
-        for (unsigned int i = 0; i < CANDY_AMOUNT; i++)
-        {
-            Vector2 movement = Vector2Scale(candy[i].velocity, frameTime);
-            candy[i].position = Vector2Add(candy[i].position, movement);
-            candy[i].velocity.y += 1000*frameTime;
-            candy[i].angle += candy[i].rotationRate*frameTime;
-        }
+        Vector2 offset = Vector2Subtract(Vector2Multiply(pinataFracture.pieces[i].center, size), pinata->origin);
+        offset = Vector2Rotate(offset, pinata->angle*DEG2RAD);
+        Vector2 burst = Vector2Scale(Vector2Normalize(offset), (float)GetRandomValue(FRAGMENT_BURST_MIN, FRAGMENT_BURST_MAX));
+        float rotationRate = (float)GetRandomValue(-FRAGMENT_SPIN, FRAGMENT_SPIN);
+        int fragment = EmitParticle(&fragments, Vector2Add(pivot, offset), Vector2Add(velocity, burst), rotationRate, i);
+        fragments.angle[fragment] = fragments.prevAngle[fragment] = pinata->angle; // Turned like the pinata was
+        fragments.source[fragment] = index;
     }
+    pinata->piecesFlying += pinataFracture.count;
+    pinata->shattered = true;
+}
+
+// Still where it started, on a straight rope
+static void HangPinata(int index)
+{
+    EntityPinata *pinata = &pinatas[index];
+    Vector2 top = { pinata->startPos.x, pinata->startPos.y - pinata->origin.y };
+    Vector2 anchor = { top.x, top.y - pinata->rect.height*PINATA_ROPE_LENGTH };
+    HangRope(&ropes, index, anchor, top);
+
+    pinata->rect.x = pinata->startPos.x;
+    pinata->rect.y = pinata->startPos.y;
+    pinata->angle = 0;
+    pinata->shattered = false;
+    pinata->prevRect = pinata->rect; // don't interpolate the jump back
+    pinata->prevAngle = pinata->angle;
+}
+
+// Hangs under the rope's end, turned the way its last segment points
+static void FollowRope(int index)
+{
+    EntityPinata *pinata = &pinatas[index];
+    Vector2 end = GetRopePoints(&ropes, index)[ROPE_SEGMENTS].position;
+    pinata->angle = GetRopeEndAngle(&ropes, index);
+    Vector2 center = Vector2Add(end, Vector2Rotate((Vector2){ 0, pinata->origin.y }, pinata->angle*DEG2RAD));
+    pinata->rect.x = center.x;
+    pinata->rect.y = center.y;
 }
 
-void SpawnCandy(void)
+void SpawnCandy(const EntityPinata *pinata)
 {
     for (unsigned int i = 0; i < CANDY_AMOUNT; i++)
     {
-        candy[i].position = (Vector2){
-            pinata.rect.x + GetRandomValue((int)-pinata.rect.width/8, (int)pinata.rect.width/8),
-            pinata.rect.y + GetRandomValue((int)-pinata.rect.height/8, (int)pinata.rect.height/8),
+        Vector2 position = {
+            pinata->rect.x + GetRandomValue((int)-pinata->rect.width/8, (int)pinata->rect.width/8),
+            pinata->rect.y + GetRandomValue((int)-pinata->rect.height/8, (int)pinata->rect.height/8),
         };
-        candy[i].velocity.x = (float)GetRandomValue(100, 1200);
-        candy[i].velocity.y = (float)GetRandomValue(-100, -1000);
-        candy[i].rotationRate = GetRandomValue(-300,300);
-        candy[i].textureId = GetRandomValue(0,7);
+        Vector2 velocity = {
+            (float)GetRandomValue(100, 1200),
+            (float)GetRandomValue(-100, -1000),
+        };
+        float rotationRate = (float)GetRandomValue(-300,300);
+        int textureId = GetRandomValue(0, CANDY_SPRITES - 1);
+        EmitParticle(&candy, position, velocity, rotationRate, textureId);
+    }
+}
+
+void StorePreviousState(void)
+{
+    for (int i = 0; i < smashedCount; i++) // The others hang still
+    {
+        EntityPinata *pinata = &pinatas[smashedPinatas[i]];
+        pinata->prevRect  = pinata->rect;
+        pinata->prevAngle = pinata->angle;
     }
+    hand.prevPosition = hand.position;
+    hand.prevAngle    = hand.angle;
+    bat.prevRect      = bat.rect;
+    bat.prevAngle     = bat.angle;
+    // Candy keeps its own previous state, see UpdateParticles()
 }
 
 // Collision
 // ----------------------------------------------------------------------------
 
+// Where the hand or the middle of the bat hits
+static Vector2 GetHitPosition(Vector2 handPosition, float batAngle)
+{
+    if (currentMode == MODE_HAND) return handPosition;
+
+    Vector2 hitOffset = Vector2Rotate((Vector2){ 0, bat.origin.y/2 }, batAngle*DEG2RAD);
+    return Vector2Subtract(handPosition, hitOffset);
+}
+
+// The bat's hit position moves on an arc as it turns, so the arc is swept
+// in straight pieces of at most BAT_SWEEP_DEGREES each
+static int GetSweepPieces(float fromAngle, float *angleDelta)
+{
+    *angleDelta = 0.0f;
+    if (currentMode != MODE_BAT) return 1;
+
+    *angleDelta = fmodf(bat.angle - fromAngle + 540.0f, 360.0f) - 180.0f; // shortest way around
+    int pieces = (int)ceilf(fabsf(*angleDelta)/BAT_SWEEP_DEGREES);
+    return (pieces < 1)? 1 : pieces;
+}
+
+// Everywhere the hit position went during the step, grown by the hand's radius
+static Rectangle GetSweepBounds(Vector2 fromPosition, float fromAngle)
+{
+    float angleDelta;
+    int pieces = GetSweepPieces(fromAngle, &angleDelta);
+    Vector2 min = GetHitPosition(fromPosition, fromAngle);
+    Vector2 max = min;
+    for (int i = 1; i <= pieces; i++)
+    {
+        float t = (float)i/pieces;
+        Vector2 point = GetHitPosition(Vector2Lerp(fromPosition, hand.position, t), fromAngle + angleDelta*t);
+        min = Vector2Min(min, point);
+        max = Vector2Max(max, point);
+    }
+
+    return (Rectangle){ min.x - hand.radius, min.y - hand.radius,
+                        max.x - min.x + 2.0f*hand.radius, max.y - min.y + 2.0f*hand.radius };
+}
+
+// Sweep the hit position from the start of the step to now, returns whether
+// it touched the pinata and how far into the step (0 to 1)
+static bool SweepHitPosition(const EntityPinata *pinata, Vector2 fromPosition, float fromAngle, float *timeOfImpact)
+{
+    Vector2 origin = { pinata->rect.width/2, pinata->rect.height/2 };
+    float angleDelta;
+    int pieces = GetSweepPieces(fromAngle, &angleDelta);
+
+    Vector2 start = GetHitPosition(fromPosition, fromAngle);
+    for (int i = 1; i <= pieces; i++)
+    {
+        float t = (float)i/pieces;
+        Vector2 end = GetHitPosition(Vector2Lerp(fromPosition, hand.position, t), fromAngle + angleDelta*t);
+        float pieceTime;
+        if (CheckCollisionSweptCircleRecRotated(start, end, hand.radius, pinata->rect, origin, pinata->angle, &pieceTime))
+        {
+            *timeOfImpact = (i - 1 + pieceTime)/pieces;
+            return true;
+        }
+        start = end;
+    }
+
+    return false;
+}
+
+static void SweepCandidates(void *data, int start, int end)
+{
+    SweepJob *sweep = data;
+    for (int i = start; i < end; i++)
+    {
+        const EntityPinata *pinata = &pinatas[sweep->candidates[i]];
+        if (pinata->smashed || !SweepHitPosition(pinata, sweep->fromPosition, sweep->fromAngle, &sweep->timesOfImpact[i]))
+            sweep->timesOfImpact[i] = -1.0f;
+    }
+}
+
 bool CheckCollisionPointRecRotated(Vector2 point, Rectangle rect, Vector2 origin, float angle)
 {
     Rectangle localRect = { 0, 0, rect.width, rect.height };
@@ -312,71 +686,212 @@ bool CheckCollisionCircleRecRotated(Vector2 center, float radius, Rectangle rect
     return CheckCollisionCircleRec(localCenter, radius, localRect);
 }
 
+bool CheckCollisionSweptCircleRecRotated(Vector2 start, Vector2 end, float radius, Rectangle rect, Vector2 origin, float angle, float *timeOfImpact)
+{
+    // In the rectangle's frame, the same one CheckCollisionCircleRecRotated()
+    // uses, it's an axis-aligned box. Work relative to the box's center.
+    Vector2 halfSize = { rect.width/2, rect.height/2 };
+    Vector2 boxCenter = { halfSize.x - origin.x*2, halfSize.y - origin.y*2 };
+    Vector2 pivot = { rect.x, rect.y };
+    Vector2 localStart = Vector2Subtract(Vector2Rotate(Vector2Subtract(start, pivot), -angle*DEG2RAD), origin);
+    Vector2 localEnd = Vector2Subtract(Vector2Rotate(Vector2Subtract(end, pivot), -angle*DEG2RAD), origin);
+    Vector2 position = Vector2Subtract(localStart, boxCenter);
+    Vector2 move = Vector2Subtract(localEnd, localStart);
+
+    // Touching already at the start
+    Vector2 closest = { Clamp(position.x, -halfSize.x, halfSize.x), Clamp(position.y, -halfSize.y, halfSize.y) };
+    if (Vector2DistanceSqr(position, closest) <= radius*radius)
+    {
+        *timeOfImpact = 0.0f;
+        return true;
+    }
+
+    // The circle's center hits the box grown by the radius, which is a
+    // rounded rectangle. First against the grown box's sides (slab test).
+    float entry = 0.0f;
+    float exit = 1.0f;
+    float from[2] = { position.x, position.y };
+    float delta[2] = { move.x, move.y };
+    float extent[2] = { halfSize.x + radius, halfSize.y + radius };
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (fabsf(delta[axis]) < EPSILON)
+        {
+            if (fabsf(from[axis]) > extent[axis]) return false;
+            continue;
+        }
+
+        float nearTime = (-extent[axis] - from[axis])/delta[axis];
+        float farTime = (extent[axis] - from[axis])/delta[axis];
+        if (nearTime > farTime) { float swap = nearTime; nearTime = farTime; farTime = swap; }
+        if (nearTime > entry) entry = nearTime;
+        if (farTime < exit) exit = farTime;
+        if (entry > exit) return false;
+    }
+
+    // Entering by a corner of the grown box, where it's rounded: the circle
+    // must hit the rectangle's corner point instead
+    Vector2 entryPoint = Vector2Add(position, Vector2Scale(move, entry));
+    if ((fabsf(entryPoint.x) > halfSize.x) && (fabsf(entryPoint.y) > halfSize.y))
+    {
+        Vector2 corner = { copysignf(halfSize.x, entryPoint.x), copysignf(halfSize.y, entryPoint.y) };
+        Vector2 toStart = Vector2Subtract(position, corner);
+        float a = Vector2DotProduct(move, move);
+        float b = Vector2DotProduct(toStart, move);
+        float c = Vector2DotProduct(toStart, toStart) - radius*radius;
+        float discriminant = b*b - a*c;
+        if ((a < EPSILON) || (discriminant < 0.0f)) return false;
+
+        entry = (-b - sqrtf(discriminant))/a;
+        if ((entry < 0.0f) || (entry > 1.0f)) return false;
+    }
+
+    *timeOfImpact = entry;
+    return true;
+}
+
 // Draw
 // ----------------------------------------------------------------------------
 
-void DrawGameFrame(void)
+void CaptureRenderState(GameRenderState *state, float alpha)
+{
+    // Blend the last two simulation steps for smooth motion at any framerate
+    state->handPosition = Vector2Lerp(hand.prevPosition, hand.position, alpha);
+    state->handAngle    = LerpAngle(hand.prevAngle, hand.angle, alpha);
+    state->batRect      = LerpRectangle(bat.prevRect, bat.rect, alpha);
+    state->batAngle     = LerpAngle(bat.prevAngle, bat.angle, alpha);
+    state->mode         = currentMode;
+    state->handGrabbed  = hand.grabbed;
+    state->showHint     = showHint;
+    state->showScore    = (timer > 0.0f); // For as long as the last hit keeps its pinata away
+    state->score        = score;
+
+    // What they're drawn with, copied too so drawing never reads what the steps write
+    state->handRadius       = hand.radius;
+    state->handOpenSprite   = hand.spriteOpen;
+    state->handClosedSprite = hand.spriteClosed;
+    state->batOrigin        = bat.origin;
+    state->batSprite        = bat.sprite;
+
+    state->pinataCount = pinataCount;
+    state->pinataSprite = (pinataCount > 0)? pinatas[0].sprite : (Sprite){ 0 };
+    for (int i = 0; i < pinataCount; i++)
+    {
+        EntityPinata *pinata = &pinatas[i];
+        state->pinatas[i].rect  = LerpRectangle(pinata->prevRect, pinata->rect, alpha);
+        state->pinatas[i].origin = pinata->origin;
+        state->pinatas[i].angle = LerpAngle(pinata->prevAngle, pinata->angle, alpha);
+        state->pinatas[i].shattered = pinata->shattered;
+
+        const RopePoint *points = GetRopePoints(&ropes, i);
+        for (int j = 0; j < ROPE_POINTS; j++)
+            state->pinatas[i].rope[j] = Vector2Lerp(points[j].previous, points[j].position, alpha);
+    }
+
+    // Candy goes straight into the instances it's drawn with
+    state->candyCount = candy.count;
+    state->candyTexture = candySprite[0].texture;
+    for (int i = 0; i < candy.count; i++)
+    {
+        Rectangle source = candySprite[candy.textureId[i]].source;
+        Vector2 previous = { candy.prevPositionX[i], candy.prevPositionY[i] };
+        Vector2 current  = { candy.positionX[i], candy.positionY[i] };
+        state->candy[i] = (SpriteInstance){
+            .position = Vector2Lerp(previous, current, alpha),
+            .size     = { 2.0f*CANDY_RADIUS, 2.0f*CANDY_RADIUS*source.height/source.width }, // as DrawSpriteCircle()
+            .source   = source,
+            .angle    = Lerp(candy.prevAngle[i], candy.angle[i], alpha),
+        };
+    }
+
+    // Pinata pieces, the same way
+    state->fragmentCount = fragments.count;
+    state->fragmentSize  = (pinataCount > 0)? (Vector2){ pinatas[0].rect.width, pinatas[0].rect.height } : Vector2Zero();
+    for (int i = 0; i < fragments.count; i++)
+    {
+        Vector2 previous = { fragments.prevPositionX[i], fragments.prevPositionY[i] };
+        Vector2 current  = { fragments.positionX[i], fragments.positionY[i] };
+        state->fragments[i] = (FragmentInstance){
+            .position = Vector2Lerp(previous, current, alpha),
+            .angle    = Lerp(fragments.prevAngle[i], fragments.angle[i], alpha),
+            .piece    = fragments.textureId[i],
+        };
+    }
+}
+
+void DrawGameFrame(const GameRenderState *state)
 {
     ClearBackground(ORANGE);
 
-    // Draw pinata
-    DrawSpriteRectangle(&pinata.sprite, pinata.rect, pinata.origin, pinata.angle);
+    // Draw ropes, behind the pinatas they hold
+    TrackDrawTexture(GetShapesTexture());
+    for (int i = 0; i < state->pinataCount; i++)
+        DrawSplineLinear(state->pinatas[i].rope, ROPE_POINTS, ROPE_THICKNESS, DARKBROWN);
+
+    // Draw pinatas
+    for (int i = 0; i < state->pinataCount; i++)
+    {
+        if (!state->pinatas[i].shattered)
+            DrawSpriteRectangle(&state->pinataSprite, state->pinatas[i].rect, state->pinatas[i].origin, state->pinatas[i].angle);
+    }
+
+    // Draw the pieces of shattered pinatas, cut from the same atlas so they join the pinatas' batch.
+    // The pattern is an asset, made while loading and only read since.
+    if (state->fragmentCount > 0)
+        DrawFragments(state->pinataSprite, &pinataFracture, state->fragments, state->fragmentCount, state->fragmentSize);
 
     // Draw hand
-    if ((currentMode == MODE_HAND) || !hand.grabbed)
-        DrawSpriteCircle(&hand.spriteOpen, hand.position, hand.radius, hand.angle);
+    if ((state->mode == MODE_HAND) || !state->handGrabbed)
+        DrawSpriteCircle(&state->handOpenSprite, state->handPosition, state->handRadius, state->handAngle);
 
     // Draw bat
-    if (currentMode == MODE_BAT)
+    if (state->mode == MODE_BAT)
     {
-        DrawSpriteRectangle(&bat.sprite, bat.rect, bat.origin, bat.angle);
-        if (hand.grabbed)
-            DrawSpriteCircle(&hand.spriteClosed, hand.position, hand.radius, hand.angle);
+        DrawSpriteRectangle(&state->batSprite, state->batRect, state->batOrigin, state->batAngle);
+        if (state->handGrabbed)
+            DrawSpriteCircle(&state->handClosedSprite, state->handPosition, state->handRadius, state->handAngle);
     }
 
+    // Text is a signed distance field font, drawn crisp at any size by its shader
+    if (textShader.id > 0) BeginShaderMode(textShader);
+
     // Draw hint
     int fontSize = 50;
     Color fontColor = RAYWHITE;
-    if (showHint)
+    if (state->showHint)
     {
-        const char *scoreText = "Click to drag";
-        int textLength = (int)MeasureTextEx(textFont, scoreText, fontSize, 0).x;
-        DrawTextEx(textFont, scoreText,
-                   (Vector2){ hand.position.x - textLength/2,
-                   hand.position.y + fontSize + 100, },
-                   fontSize, 0, fontColor);
+        const TextLayout *hintText = GetTextLayout(textFont, "Click to drag", fontSize, 0);
+        TrackDrawTexture(textFont.texture);
+        int textLength = (int)hintText->size.x;
+        DrawTextLayout(hintText, textFont,
+                       (Vector2){ state->handPosition.x - textLength/2,
+                       state->handPosition.y + fontSize + 100, },
+                       fontColor);
     }
 
     // Draw score message
-    if (pinata.smashed)
+    if (state->showScore)
     {
         Color fontColor = ColorBrightness(YELLOW,0.5);
-        if (score > 400.0f)
+        if (state->score > 400.0f)
         {
             fontColor = ColorBrightness(RED, 0.1f);
             DrawCenterText("How?!", fontColor, false);
         }
-        else if (score > 200.0f)
+        else if (state->score > 200.0f)
         {
             fontColor = YELLOW;
             DrawCenterText("Holy Crap!", fontColor, false);
         }
         else DrawCenterText("Swing harder!", fontColor, false);
 
-        DrawCenterText(TextFormat("Score: %.0f", score),
-                       fontColor, true);
+        DrawCenterText(GetScoreText(state->score), fontColor, true);
     }
 
-    // Draw candy
-    if (pinata.smashed && (score > 200.0f))
-    {
-        for (unsigned int i = 0; i < CANDY_AMOUNT; i++)
-        {
-            DrawSpriteCircle(&candyTexture[candy[i].textureId],
-                             candy[i].position,
-                             30, candy[i].angle);
-        }
-    }
+    EndShaderMode();
+
+    // Draw candy, all of it in one instanced draw (see instancing.h)
+    DrawSpriteInstances(state->candyTexture, state->candy, state->candyCount);
 
     // // Debug
     // const int textSize = 50;
@@ -394,34 +909,70 @@ void DrawGameFrame(void)
     // DrawText(TextFormat("hand angle: %.0f", hand.angle), textX, textY, textSize, RAYWHITE);
 }
 
-void DrawSpriteRectangle(Texture *sprite, Rectangle rect, Vector2 origin, float angle)
+void DrawSpriteRectangle(const Sprite *sprite, Rectangle rect, Vector2 origin, float angle)
 {
-    Rectangle src = { 0, 0, (float)sprite->width, (float)sprite->height };
-    DrawTexturePro(*sprite, src, rect, origin, angle, WHITE);
+    TrackDrawTexture(sprite->texture);
+    DrawTexturePro(sprite->texture, sprite->source, rect, origin, angle, WHITE);
 }
 
-void DrawSpriteCircle(Texture *sprite, Vector2 center, float radius, float angle)
+void DrawSpriteCircle(const Sprite *sprite, Vector2 center, float radius, float angle)
 {
-    float spriteScale = radius*2.0f/sprite->width;
-    Rectangle spriteSrc = { 0.0f, 0.0f, (float)sprite->width, (float)sprite->height };
+    Rectangle spriteSrc = sprite->source;
+    float spriteScale = radius*2.0f/spriteSrc.width;
     Rectangle spriteDest = {
         center.x, center.y,
-        sprite->width*spriteScale, sprite->height*spriteScale
+        spriteSrc.width*spriteScale, spriteSrc.height*spriteScale
     };
     Vector2 spriteOrigin = {
-        sprite->width/2*spriteScale,
-        sprite->height/2*spriteScale };
+        (int)spriteSrc.width/2*spriteScale,
+        (int)spriteSrc.height/2*spriteScale };
 
-    DrawTexturePro(*sprite, spriteSrc, spriteDest, spriteOrigin, angle, WHITE);
+    TrackDrawTexture(sprite->texture);
+    DrawTexturePro(sprite->texture, spriteSrc, spriteDest, spriteOrigin, angle, WHITE);
 }
 
 void DrawCenterText(const char* text, Color fontColor, bool nextLine)
 {
     const int fontSize = 130;
     float offset = nextLine? fontSize : 0;
-    int textLength = (int)MeasureTextEx(textFont, text, fontSize, 0).x;
-    DrawTextEx(textFont, text,
-               (Vector2){ (VIRTUAL_WIDTH - textLength)/2,
-               (VIRTUAL_HEIGHT - fontSize)/2 - 200 + offset, },
-               fontSize, 0, fontColor);
+    const TextLayout *layout = GetTextLayout(textFont, text, fontSize, 0);
+    TrackDrawTexture(textFont.texture);
+    int textLength = (int)layout->size.x;
+    DrawTextLayout(layout, textFont,
+                   (Vector2){ (VIRTUAL_WIDTH - textLength)/2,
+                   (VIRTUAL_HEIGHT - fontSize)/2 - 200 + offset, },
+                   fontColor);
+}
+
+// Only formatted again when the shown score changes
+static const char *GetScoreText(float score)
+{
+    static char scoreText[32] = { 0 };
+    static float shownScore = -1.0f;
+
+    float roundedScore = roundf(score);
+    if (roundedScore != shownScore)
+    {
+        snprintf(scoreText, sizeof(scoreText), "Score: %.0f", roundedScore);
+        shownScore = roundedScore;
+    }
+    return scoreText;
+}
+
+Rectangle LerpRectangle(Rectangle previous, Rectangle current, float amount)
+{
+    return (Rectangle){
+        Lerp(previous.x, current.x, amount),
+        Lerp(previous.y, current.y, amount),
+        Lerp(previous.width, current.width, amount),
+        Lerp(previous.height, current.height, amount),
+    };
+}
+
+float LerpAngle(float previous, float current, float amount)
+{
+    float angleDelta = fmodf(current - previous, 360.0f);
+    if (angleDelta > 180.0f) angleDelta -= 360.0f;
+    if (angleDelta < -180.0f) angleDelta += 360.0f;
+    return previous + angleDelta*amount;
 }
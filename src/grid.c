@@ -0,0 +1,141 @@
+// EXPLANATION:
+// Uniform grid for broad-phase collision
+// See grid.h for more documentation/descriptions
+
+#include "grid.h"
+
+#include <math.h> // floorf, ceilf, sqrtf
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static bool GetCellRange(const SpatialGrid *grid, Rectangle area, int *minX, int *minY, int *maxX, int *maxY);
+
+// Grid
+// ----------------------------------------------------------------------------
+
+bool BuildSpatialGrid(SpatialGrid *grid, const Rectangle *bounds, int count, float cellSize, Arena *arena)
+{
+    *grid = (SpatialGrid){ 0 };
+    if (count <= 0) return true;
+
+    // Cover all the bounds
+    Vector2 min = { bounds[0].x, bounds[0].y };
+    Vector2 max = { bounds[0].x + bounds[0].width, bounds[0].y + bounds[0].height };
+    for (int i = 1; i < count; i++)
+    {
+        min.x = fminf(min.x, bounds[i].x);
+        min.y = fminf(min.y, bounds[i].y);
+        max.x = fmaxf(max.x, bounds[i].x + bounds[i].width);
+        max.y = fmaxf(max.y, bounds[i].y + bounds[i].height);
+    }
+
+    float width = fmaxf(max.x - min.x, 1.0f);
+    float height = fmaxf(max.y - min.y, 1.0f);
+    if (cellSize <= 0.0f) cellSize = fmaxf(width, height);
+    if ((width/cellSize)*(height/cellSize) > GRID_MAX_CELLS)
+        cellSize = sqrtf(width*height/GRID_MAX_CELLS);
+
+    grid->origin = min;
+    grid->cellSize = cellSize;
+    grid->columns = (int)ceilf(width/cellSize);
+    grid->rows = (int)ceilf(height/cellSize);
+    if (grid->columns < 1) grid->columns = 1;
+    if (grid->rows < 1) grid->rows = 1;
+    grid->itemCount = count;
+
+    int cellCount = grid->columns*grid->rows;
+    grid->cellStart = ArenaAlloc(arena, (size_t)(cellCount + 1)*sizeof(int)); // zeroed
+    grid->itemQuery = ArenaAlloc(arena, (size_t)count*sizeof(unsigned int));
+    if ((grid->cellStart == NULL) || (grid->itemQuery == NULL))
+    {
+        *grid = (SpatialGrid){ 0 };
+        return false;
+    }
+
+    // Count the items in each cell, then turn the counts into where each
+    // cell's items end
+    int total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int minX, minY, maxX, maxY;
+        GetCellRange(grid, bounds[i], &minX, &minY, &maxX, &maxY);
+        for (int y = minY; y <= maxY; y++)
+            for (int x = minX; x <= maxX; x++)
+                grid->cellStart[y*grid->columns + x]++;
+        total += (maxX - minX + 1)*(maxY - minY + 1);
+    }
+
+    for (int c = 1; c < cellCount; c++)
+        grid->cellStart[c] += grid->cellStart[c - 1];
+    grid->cellStart[cellCount] = total;
+
+    grid->items = ArenaAlloc(arena, (size_t)total*sizeof(int));
+    if (grid->items == NULL)
+    {
+        *grid = (SpatialGrid){ 0 };
+        return false;
+    }
+
+    // Fill from the back, which leaves each cell's items in index order and
+    // cellStart at where each cell's items begin
+    for (int i = count - 1; i >= 0; i--)
+    {
+        int minX, minY, maxX, maxY;
+        GetCellRange(grid, bounds[i], &minX, &minY, &maxX, &maxY);
+        for (int y = minY; y <= maxY; y++)
+            for (int x = minX; x <= maxX; x++)
+                grid->items[--grid->cellStart[y*grid->columns + x]] = i;
+    }
+
+    return true;
+}
+
+int QuerySpatialGrid(SpatialGrid *grid, Rectangle area, int *results, int maxResults)
+{
+    int minX, minY, maxX, maxY;
+    if ((grid->items == NULL) || !GetCellRange(grid, area, &minX, &minY, &maxX, &maxY)) return 0;
+
+    // A new stamp per query marks items already found, nothing to clear
+    grid->queryCount++;
+    if (grid->queryCount == 0)
+    {
+        for (int i = 0; i < grid->itemCount; i++) grid->itemQuery[i] = 0;
+        grid->queryCount = 1;
+    }
+
+    int resultCount = 0;
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int x = minX; x <= maxX; x++)
+        {
+            int cell = y*grid->columns + x;
+            for (int j = grid->cellStart[cell]; j < grid->cellStart[cell + 1]; j++)
+            {
+                int item = grid->items[j];
+                if (grid->itemQuery[item] == grid->queryCount) continue;
+                if (resultCount == maxResults) return resultCount;
+
+                grid->itemQuery[item] = grid->queryCount;
+                results[resultCount++] = item;
+            }
+        }
+    }
+
+    return resultCount;
+}
+
+// Cells the area overlaps, clamped to the grid, false when it misses the grid
+static bool GetCellRange(const SpatialGrid *grid, Rectangle area, int *minX, int *minY, int *maxX, int *maxY)
+{
+    float left = floorf((area.x - grid->origin.x)/grid->cellSize);
+    float top = floorf((area.y - grid->origin.y)/grid->cellSize);
+    float right = floorf((area.x + area.width - grid->origin.x)/grid->cellSize);
+    float bottom = floorf((area.y + area.height - grid->origin.y)/grid->cellSize);
+    if ((right < 0.0f) || (bottom < 0.0f) || (left >= grid->columns) || (top >= grid->rows)) return false;
+
+    *minX = (left < 0.0f)? 0 : (int)left;
+    *minY = (top < 0.0f)? 0 : (int)top;
+    *maxX = (right >= grid->columns)? grid->columns - 1 : (int)right;
+    *maxY = (bottom >= grid->rows)? grid->rows - 1 : (int)bottom;
+    return true;
+}
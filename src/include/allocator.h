@@ -0,0 +1,92 @@
+// EXPLANATION:
+// Tracked heap allocation
+// Game code allocates through GameAlloc()/GameFree() instead of malloc or
+// MemAlloc, so every allocation is counted and the benchmark can report
+// exactly how much the game touches the heap.
+//
+// raylib's own allocations can be counted too: when CMake builds raylib from
+// source it force-includes this header with TRACK_RAYLIB_ALLOCATIONS defined,
+// which routes RL_MALLOC, RL_CALLOC, RL_REALLOC and RL_FREE (which stb,
+// miniaudio and the other bundled libraries use as well) to the Tracked*
+// functions below. The prebuilt libraries in raylib/lib can't be routed, with
+// those only the game's allocations are counted.
+//
+// Counters are atomic, the loader thread and the audio thread allocate too.
+//
+// Arenas hand out memory from one block with a bump pointer, and give it all
+// back at once: no per-allocation header, no free list, no fragmentation.
+// frameArena is reset at the start of every frame, anything the frame needs
+// only until it's drawn (formatted text, sprite batches) can come from it and
+// never be freed. stepArena is the same for one simulation step (collision
+// candidates), reset as each step begins, so steps can run on another thread
+// while the frame draws (see PIPELINED_SIMULATION in config.h).
+// persistentArena holds the level data, set up once by InitGameState() and
+// reset when the world is built again. An arena is used by one thread at a time.
+
+#ifndef SMASHTHEPINATA_ALLOCATOR_HEADER_GUARD
+#define SMASHTHEPINATA_ALLOCATOR_HEADER_GUARD
+
+#include <stddef.h> // size_t
+#include <stdbool.h>
+
+// Macros
+// ----------------------------------------------------------------------------
+#define ARENA_ALIGNMENT 16                   // Every arena allocation starts aligned to this
+#define FRAME_ARENA_SIZE (256*1024)          // Bytes of scratch per frame
+#define STEP_ARENA_SIZE (64*1024)            // Bytes of scratch per simulation step
+#define PERSISTENT_ARENA_SIZE (1024*1024)    // Bytes of level data
+
+// raylib's allocator, ahead of its defaults (see above)
+#if defined(TRACK_RAYLIB_ALLOCATIONS)
+    #define RL_MALLOC(sz) TrackedMalloc(sz)
+    #define RL_CALLOC(n, sz) TrackedCalloc(n, sz)
+    #define RL_REALLOC(ptr, sz) TrackedRealloc(ptr, sz)
+    #define RL_FREE(ptr) TrackedFree(ptr)
+#endif
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef struct AllocationStats {
+    unsigned long long allocations; // Total calls to GameAlloc()
+    unsigned long long frees;       // Total calls to GameFree()
+    size_t bytesInUse;              // Currently allocated
+    size_t peakBytesInUse;
+    unsigned long long libraryAllocations; // raylib's mallocs, callocs and reallocs (see above)
+    unsigned long long libraryFrees;
+} AllocationStats;
+
+typedef struct Arena {
+    unsigned char *memory; // One GameAlloc() block
+    size_t capacity;
+    size_t used;
+    size_t peak;           // Most ever used at once, for tuning the size
+    bool overflowed;       // Warned already, so a full frame arena doesn't flood the log
+} Arena;
+
+// Global Variables Declaration
+// ----------------------------------------------------------------------------
+extern Arena frameArena;      // Reset at the start of every frame
+extern Arena stepArena;       // Reset at the start of every simulation step
+extern Arena persistentArena; // Level data, reset by InitGameWorld()
+
+// Prototypes
+// ----------------------------------------------------------------------------
+void *GameAlloc(size_t size); // Zeroed, 16-byte aligned
+void GameFree(void *ptr);
+AllocationStats GetAllocationStats(void);
+unsigned long long GetAllocationCount(void); // Every heap allocation so far, game and raylib
+
+// raylib's allocator, counted but not sized (raylib may free what it didn't allocate)
+void *TrackedMalloc(size_t size);
+void *TrackedCalloc(size_t count, size_t size);
+void *TrackedRealloc(void *ptr, size_t size);
+void TrackedFree(void *ptr);
+
+// Arenas
+void InitArena(Arena *arena, size_t capacity);
+void FreeArena(Arena *arena);
+void ResetArena(Arena *arena); // Everything allocated from it is gone
+void *ArenaAlloc(Arena *arena, size_t size); // Zeroed, aligned, NULL when the arena is full
+const char *ArenaFormat(Arena *arena, const char *format, ...); // Like TextFormat(), "" when the arena is full
+
+#endif // SMASHTHEPINATA_ALLOCATOR_HEADER_GUARD
@@ -0,0 +1,58 @@
+// EXPLANATION:
+// Loads game assets from one packed archive file (assets.pak)
+// Opening, reading and closing every asset file separately costs many system
+// calls at startup. The archive is mapped into memory once and raylib decodes
+// each asset straight from the mapping with its *FromMemory() functions.
+//
+// Assets are looked up by their usual path, e.g. "assets/pinata.png". When
+// there's no archive, or it lacks an asset, the loose file is loaded instead,
+// so the game also runs straight from the assets directory.
+//
+// The archive is made by the pack_assets tool (src/tools/pack_assets.c).
+
+#ifndef SMASHTHEPINATA_ARCHIVE_HEADER_GUARD
+#define SMASHTHEPINATA_ARCHIVE_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define ARCHIVE_FILE_NAME "assets.pak"
+#define ARCHIVE_MAGIC "STPK"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_NAME_LENGTH 56 // Including the terminating zero
+#define ARCHIVE_ALIGNMENT 16   // Asset data starts at multiples of this
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// File layout: header, entry table, then the data of every asset
+// Values are little-endian, offsets are from the start of the file
+typedef struct ArchiveHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int reserved;
+} ArchiveHeader;
+
+typedef struct ArchiveEntry {
+    char name[ARCHIVE_NAME_LENGTH];
+    unsigned int offset;
+    unsigned int size;
+} ArchiveEntry;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+bool OpenAssetArchive(const char *fileName); // Map the archive, false if missing or invalid, a bare file name is also looked for next to the executable
+void CloseAssetArchive(void);                // Unload everything loaded from it first (music streams read from it)
+bool IsAssetArchiveOpen(void);
+const unsigned char *GetAssetData(const char *fileName, int *dataSize); // NULL if not in the archive
+
+// Same as raylib's loaders, but from the archive when possible
+Image LoadAssetImage(const char *fileName);
+Wave LoadAssetWave(const char *fileName);
+Sound LoadAssetSound(const char *fileName);
+Music LoadAssetMusicStream(const char *fileName);
+Font LoadAssetFont(const char *fileName, int fontSize, int *codepoints, int codepointCount);
+
+#endif // SMASHTHEPINATA_ARCHIVE_HEADER_GUARD
@@ -0,0 +1,52 @@
+// EXPLANATION:
+// Packs many small images into one texture (a sprite atlas)
+// Drawing sprites that share a texture lets raylib put them all in a single
+// batch, switching textures between sprites forces a separate draw call.
+
+#ifndef SMASHTHEPINATA_ATLAS_HEADER_GUARD
+#define SMASHTHEPINATA_ATLAS_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define ATLAS_MAX_SPRITES 32
+#define ATLAS_PADDING 2        // Empty pixels around sprites, so filtering doesn't bleed
+#define ATLAS_MAX_SIZE 4096    // Largest texture size allowed on all platforms
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// A region of a texture, drawn like a texture of its own
+typedef struct Sprite {
+    Texture texture;
+    Rectangle source;
+} Sprite;
+
+typedef struct SpriteAtlas {
+    Texture texture;
+    Rectangle regions[ATLAS_MAX_SPRITES];
+    int count;
+} SpriteAtlas;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+
+// Load image files and pack them into one atlas, in the given order
+SpriteAtlas LoadSpriteAtlas(const char **fileNames, int count);
+SpriteAtlas LoadSpriteAtlasFromImage(Image packed, const Rectangle *regions, int count); // Upload an image packed by LoadAtlasImage()
+void UnloadSpriteAtlas(SpriteAtlas atlas);
+Sprite GetAtlasSprite(SpriteAtlas atlas, int index);
+
+// Pack images into one image (CPU only), writing each image's region, empty if they don't fit
+Image GenImageAtlas(const Image *images, int count, Rectangle *regions);
+Image LoadAtlasImage(const char **fileNames, int count, Rectangle *regions); // Same, from image files
+
+// Draw statistics
+// Counts texture switches between draws, each one breaks raylib's batch
+void ResetDrawStats(void);                 // Call at the start of the frame
+void TrackDrawTexture(Texture texture);    // Call before drawing with a texture
+void TrackDrawCall(void);                  // A draw of its own, outside raylib's batch
+int GetDrawBatchCount(void);               // Batches used so far this frame
+
+#endif // SMASHTHEPINATA_ATLAS_HEADER_GUARD
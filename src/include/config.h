@@ -16,8 +16,38 @@
 #define INITIAL_HEIGHT 720 // Default size of the game window
 #define INITIAL_WIDTH (int)(INITIAL_HEIGHT*ASPECT_RATIO)
 
-// there may be small bugs with very high FPS (uncapped + no vsync), but should work fine overall
 #define MAX_FRAMERATE 120 // Set to 0 for uncapped framerate
 #define VSYNC_ENABLED true
 
+// The game simulates in fixed steps, independent of the framerate above,
+// and rendering interpolates between the last two steps
+#define SIMULATION_RATE 120     // Simulation steps per second
+#define MAX_SIMULATION_STEPS 8  // Per rendered frame, slower frames fall behind instead of piling up steps
+
+// Pipelining runs a frame's simulation steps on a job worker while the main
+// thread draws the previous frame's state, so the simulation's cost hides
+// behind the draw calls, at the price of one frame of latency. It needs
+// threads (not on web), and --pipelined turns it on when this is false.
+#define PIPELINED_SIMULATION false
+
+// The game renders to a texture at an internal resolution between these two
+// scales of VIRTUAL_HEIGHT (never above the window's), then scales it up to
+// the window, so fill cost no longer grows with the window size. Set
+// RENDER_TO_TEXTURE to false to draw straight to the window instead.
+#define RENDER_TO_TEXTURE true
+#define RENDER_SCALE_MIN 0.5f
+#define RENDER_SCALE_MAX 1.0f
+
+// Dynamic resolution lowers the render scale while frames take longer than
+// the display's refresh (or MAX_FRAMERATE), and tries it back up once they
+// keep pace again
+#define DYNAMIC_RESOLUTION true
+#define RENDER_SCALE_STEP 0.1f   // Change per adjustment
+#define RENDER_SCALE_COOLDOWN 0.5f // Seconds between adjustments, lets the frame times settle
+
+// Frame profiler, F3 shows its overlay (build with -DPROFILER_ENABLED=0 to compile it out)
+#ifndef PROFILER_ENABLED
+    #define PROFILER_ENABLED 1
+#endif
+
 #endif // SMASHTHEPINATA_CONFIG_HEADER_GUARD
@@ -0,0 +1,56 @@
+// EXPLANATION:
+// Breaks a sprite into pieces along a Voronoi pattern, for shattering pinatas
+// The pattern is made once, when assets load: seed points are spread over the
+// sprite's opaque pixels (its alpha mask), and each seed's piece is the part
+// of the sprite closer to it than to any other seed, a convex polygon. Each
+// piece's center is the middle of its opaque pixels, so it turns around its
+// center of mass once it flies off.
+//
+// Pieces are drawn as textured polygons cut from the sprite's own atlas
+// region, in the same batch as the sprites (see atlas.h). Nothing is made or
+// allocated when something shatters, the pattern is only copied into place.
+
+#ifndef SMASHTHEPINATA_FRACTURE_HEADER_GUARD
+#define SMASHTHEPINATA_FRACTURE_HEADER_GUARD
+
+#include "raylib.h"
+#include "atlas.h" // Sprite
+
+// Macros
+// ----------------------------------------------------------------------------
+#define FRACTURE_PIECES 16                              // Most pieces in a pattern
+#define FRACTURE_MAX_VERTICES (4 + FRACTURE_PIECES - 1) // A rectangle gaining a vertex from each other seed's cut
+#define FRACTURE_ALPHA_THRESHOLD 128                    // Pixels at least this opaque belong to the sprite
+#define FRACTURE_SEED_CANDIDATES 16                     // Tries per seed, the one farthest from the others wins
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// Coordinates are 0 to 1 across the sprite, so a pattern fits any size
+typedef struct FracturePiece {
+    Vector2 center;                          // Middle of its opaque pixels
+    Vector2 vertices[FRACTURE_MAX_VERTICES]; // Convex, in the order DrawTexturePro() winds its quads
+    int vertexCount;
+} FracturePiece;
+
+typedef struct FracturePattern {
+    FracturePiece pieces[FRACTURE_PIECES];
+    int count;
+} FracturePattern;
+
+// One piece where it flew to
+typedef struct FragmentInstance {
+    Vector2 position; // Of the piece's center
+    float angle;      // Degrees, like DrawTexturePro()
+    int piece;        // In the pattern
+} FragmentInstance;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+FracturePattern GenFracturePattern(Image image, int pieceCount, unsigned int seed); // Same seed, same pattern, safe on any thread
+FracturePattern LoadFracturePattern(const char *fileName, int pieceCount);         // From an image file (or the archive)
+
+// Draw pieces of a sprite drawn at the given size, all tinted white
+void DrawFragments(Sprite sprite, const FracturePattern *pattern, const FragmentInstance *fragments, int count, Vector2 size);
+
+#endif // SMASHTHEPINATA_FRACTURE_HEADER_GUARD
@@ -1,70 +1,152 @@
 // EXPLANATION:
 // All the game logic, including how/when to draw to screen
+// There's one big pinata, or for the arcade pinata wall (--wall <count>)
+// a pool of many small ones. Each hangs from its own rope (see rope.h) and
+// swings on it when hit, and a uniform grid (see grid.h) finds the few
+// pinatas near a swing, so hit testing doesn't grow with the size of the wall.
+// A big smash shatters a pinata into the pieces of its fracture pattern (see
+// fracture.h), which fly off as particles (see particles.h) until it's back.
 
 #ifndef SMASHTHEPINATA_GAME_HEADER_GUARD
 #define SMASHTHEPINATA_GAME_HEADER_GUARD
 
 #include "raylib.h"
+#include "atlas.h"
+#include "instancing.h"
+#include "rope.h"
+#include "fracture.h"
 
 // Macros
 // ----------------------------------------------------------------------------
-#define CANDY_AMOUNT 50
+#define CANDY_AMOUNT 50    // Candy spawned by a big smash
+#define CANDY_CAPACITY 1024 // Most candy alive at once, raise for bigger bursts
+#define CANDY_GRAVITY 1000.0f
+#define CANDY_RADIUS 30.0f
+#define BAT_SWEEP_DEGREES 10.0f // Longest piece of the bat's arc swept as a straight line
+#define PINATA_WALL_MAX 1024    // Most pinatas in the arcade pinata wall
+#define PINATA_WALL_WIDTH 0.55f // Part of the screen the wall covers, from the left
+#define PINATA_ROPE_LENGTH (1.0f/3.0f) // Of the pinata's height
+#define PINATA_GRAVITY 1000.0f  // Pulls on the ropes
+#define PINATA_HIT_PUSH 5.0f    // Pixels per second a hit pushes the pinata, per unit of swing speed
+#define ROPE_THICKNESS 6.0f
+#define FRAGMENT_CAPACITY 1024  // Most pieces of shattered pinatas flying at once
+#define FRAGMENT_PUSH 0.25f     // Part of the hit's push the pieces get
+#define FRAGMENT_BURST_MIN 200  // Pixels per second the pieces fly apart
+#define FRAGMENT_BURST_MAX 600
+#define FRAGMENT_SPIN 360       // Most degrees per second a piece turns
 
 // Types and Structures
 // ----------------------------------------------------------------------------
 
+// Things that happened during a simulation step, for audio and other effects
+typedef enum {
+    EVENT_NONE      = 0,
+    EVENT_HIT       = 1 << 0, // Pinata got smashed
+    EVENT_BIG_SMASH = 1 << 1, // ...hard enough to spill candy
+    EVENT_RESET     = 1 << 2, // Every pinata is back for another go
+} GameEvent;
+
 typedef enum { SCREEN_LOGO, SCREEN_GAMEPLAY } ScreenState;
 
 typedef enum { MODE_BAT, MODE_HAND } GameMode;
 
+// Sprites in the game's atlas, in the order they're packed
+typedef enum {
+    SPRITE_PINATA, SPRITE_BAT, SPRITE_HAND_OPEN, SPRITE_HAND_CLOSED,
+    SPRITE_CANDY, // First of CANDY_SPRITES consecutive candy sprites
+    SPRITE_COUNT = SPRITE_CANDY + 8
+} SpriteId;
+#define CANDY_SPRITES (SPRITE_COUNT - SPRITE_CANDY)
+
 typedef struct {
-    Texture sprite;
-    Sound soundHit;
+    Sprite sprite;
     Rectangle rect;
-    Vector2 startPos;
+    Rectangle prevRect; // From the previous simulation step, for interpolation
+    Vector2 startPos; // Where it hangs still
     Vector2 origin;
-    float scale;
     float angle;
-    float spinRate;
-    float xVelocity;
+    float prevAngle;
+    float resetTimer; // Seconds until a smashed pinata is back
+    int piecesFlying; // Shattered, it's only back once they've all fallen off the screen
     bool smashed;
+    bool shattered; // Its pieces are flying instead, only the rope is left
 } EntityPinata;
 
 typedef struct {
-    Texture sprite;
-    Sound soundHit;
+    Sprite sprite;
     Rectangle rect;
+    Rectangle prevRect;
     Vector2 origin;
     float angle;
+    float prevAngle;
     float startAngle;
 } EntityBat;
 
 typedef struct {
-    Texture spriteOpen;
-    Texture spriteClosed;
+    Sprite spriteOpen;
+    Sprite spriteClosed;
     Vector2 position;
+    Vector2 prevPosition;
     Vector2 velocity;
     Vector2 startPos;
     float radius;
     float angle;
+    float prevAngle;
     float startAngle;
     bool grabbed;
 } EntityHand;
 
+// Where a pinata and its rope are drawn
 typedef struct {
-    Vector2 position;
-    Vector2 velocity;
-    int textureId;
-    Color color;
+    Rectangle rect;
+    Vector2 origin;
     float angle;
-    float rotationRate;
-} Candy;
+    bool shattered;
+    Vector2 rope[ROPE_POINTS];
+} PinataRenderState;
+
+// Everything DrawGameFrame() needs from the simulation, already blended
+// between the last two steps. A copy of its own, so the next steps can run
+// while it's drawn (see PIPELINED_SIMULATION in config.h). Drawing reads
+// nothing else the simulation owns, only assets that are done loading.
+typedef struct {
+    Vector2 handPosition;
+    float handAngle;
+    float handRadius;
+    Sprite handOpenSprite;
+    Sprite handClosedSprite;
+    Rectangle batRect;
+    float batAngle;
+    Vector2 batOrigin;
+    Sprite batSprite;
+    Sprite pinataSprite; // All the pinatas share it
+    GameMode mode;
+    bool handGrabbed;
+    bool showHint;
+    bool showScore;
+    float score;
+    int pinataCount;
+    int candyCount;
+    int fragmentCount;
+    Vector2 fragmentSize; // Of the pinatas they broke from, all the same size
+    Texture candyTexture;
+    PinataRenderState pinatas[PINATA_WALL_MAX];
+    SpriteInstance candy[CANDY_CAPACITY];
+    FragmentInstance fragments[FRAGMENT_CAPACITY];
+} GameRenderState;
 
 // Game state, used across project
 extern Camera2D camera;
 extern ScreenState currentScreen;
-extern float frameTime;
+extern float frameTime;   // Duration of one simulation step
+extern float renderAlpha; // Blend between previous and current simulation step when drawing
+extern double stepTime;   // Real time the current simulation step stands for, GetProfilerTime() clock
 extern bool gameShouldExit;
+extern bool gameLoaded;     // Assets finished loading and the game world is set up
+extern unsigned int gameEvents; // GameEvent flags raised by the last simulation step
+extern int pinataWallSize;      // 0 for the single big pinata, else pinatas in the wall, read by InitGameWorld()
+extern const char *spriteFiles[SPRITE_COUNT];
+extern FracturePattern pinataFracture; // Made from the pinata sprite as assets load
 
 // Prototypes
 // ----------------------------------------------------------------------------
@@ -72,21 +154,32 @@ extern bool gameShouldExit;
 // Initialization
 void InitGameState(void); // Initialize game data and allocate memory for sounds
 void FreeGameState(void); // Free any allocated memory within game state
-Texture LoadFilteredTexture(char* path);
+void LoadGameAssets(void); // Queue font, sounds and sprite atlas for loading (see loader.h)
+bool UpdateGameLoading(void); // Call every frame until it returns true, then the game world is ready
+void InitGameWorld(SpriteAtlas spriteAtlas); // Set up entities, only sprite sizes are read from the atlas
+void FreeGameWorld(void);
 
 // Update
-void UpdateGameFrame(void); // Updates all the game's data and objects for the current frame
-void SpawnCandy(void);
+void UpdateGameFrame(void); // Advances the game's data and objects by one simulation step
+void UpdateGameSimulation(void); // Game logic for one step, touches no window or audio device
+void UpdateGameAudio(void); // Music, sounds and whoosh for the step that just ran
+void StorePreviousState(void); // Remember positions before a step, for interpolated drawing
+void CaptureRenderState(GameRenderState *state, float alpha); // Alpha blends the last two steps, see renderAlpha
+void SpawnCandy(const EntityPinata *pinata);
 
 // Collision (for rotated rectangles)
 bool CheckCollisionPointRecRotated(Vector2 point, Rectangle rect, Vector2 origin, float angle);
 bool CheckCollisionCircleRecRotated(Vector2 center, float radius, Rectangle rect, Vector2 origin, float angle);
+bool CheckCollisionSweptCircleRecRotated(Vector2 start, Vector2 end, float radius, Rectangle rect, Vector2 origin,
+                                         float angle, float *timeOfImpact); // Circle moving from start to end, time is 0 to 1
 
 // Draw
-void DrawGameFrame(void); // Draws all the game's objects for the current frame
-void DrawSpriteRectangle(Texture *sprite, Rectangle rect, Vector2 origin, float angle);
-void DrawSpriteCircle(Texture *sprite, Vector2 center, float radius, float angle);
-void DrawCenterText(const char* text, Color fontColor, bool nextLine);
+void DrawGameFrame(const GameRenderState *state); // Draws all the game's objects for the current frame
+void DrawSpriteRectangle(const Sprite *sprite, Rectangle rect, Vector2 origin, float angle);
+void DrawSpriteCircle(const Sprite *sprite, Vector2 center, float radius, float angle);
+void DrawCenterText(const char* text, Color fontColor, bool nextLine); // Call in the text shader's mode (see text.h)
+Rectangle LerpRectangle(Rectangle previous, Rectangle current, float amount);
+float LerpAngle(float previous, float current, float amount); // Takes the shortest way around
 
 // Misc
 
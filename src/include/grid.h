@@ -0,0 +1,40 @@
+// EXPLANATION:
+// Uniform grid for broad-phase collision
+// Items are bucketed by which grid cells their bounds overlap, so a query
+// only looks at the items in the cells its area touches: testing a swing
+// against a wall of hundreds of pinatas costs the same as against a few.
+// Exact tests are left to the caller, the grid only returns candidates.
+//
+// The grid is built once from the items' bounds and kept in an arena. Items
+// that move outside their bounds need the grid built again.
+
+#ifndef SMASHTHEPINATA_GRID_HEADER_GUARD
+#define SMASHTHEPINATA_GRID_HEADER_GUARD
+
+#include "raylib.h"
+#include "allocator.h" // Arena
+
+// Macros
+// ----------------------------------------------------------------------------
+#define GRID_MAX_CELLS 4096 // Cells are made bigger if the bounds would need more
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef struct SpatialGrid {
+    Vector2 origin;          // Top left corner of the first cell
+    float cellSize;
+    int columns;
+    int rows;
+    int *cellStart;          // Cell c's items are items[cellStart[c]] up to items[cellStart[c + 1]]
+    int *items;              // Item indices, grouped by cell
+    unsigned int *itemQuery; // Last query that found each item, so one in several cells is found once
+    unsigned int queryCount;
+    int itemCount;
+} SpatialGrid;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+bool BuildSpatialGrid(SpatialGrid *grid, const Rectangle *bounds, int count, float cellSize, Arena *arena); // False when the arena is full
+int QuerySpatialGrid(SpatialGrid *grid, Rectangle area, int *results, int maxResults); // Items near the area, each once, returns how many
+
+#endif // SMASHTHEPINATA_GRID_HEADER_GUARD
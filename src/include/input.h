@@ -0,0 +1,69 @@
+// EXPLANATION:
+// Player input, latched once per rendered frame
+// The simulation runs in fixed steps (see SIMULATION_RATE in config.h), so a
+// rendered frame can run several steps or none at all. One-shot presses are
+// latched here until a simulation step has seen them, so no press is doubled
+// or lost regardless of the render rate.
+//
+// The mouse is sampled at every movement event between frames, each sample
+// with the time it happened, and every simulation step reads the mouse where
+// it was at that step's time. The hand then follows the mouse's real path
+// instead of jumping once per rendered frame, so swing speed (and the score)
+// doesn't depend on the frame rate.
+//
+// Gameplay input can also be recorded to a file, one record per simulation
+// step together with the random seed, and replayed later. A replay runs the
+// exact same swings, smashes and candy bursts every time, which makes
+// profiling sessions and benchmark runs comparable.
+
+#ifndef SMASHTHEPINATA_INPUT_HEADER_GUARD
+#define SMASHTHEPINATA_INPUT_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define INPUT_FILE_MAGIC "STPR"
+#define INPUT_FILE_VERSION 2
+#define INPUT_MAX_MOUSE_SAMPLES 256 // Recent mouse path kept for the simulation steps
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+typedef struct GameInput {
+    Vector2 mousePosition; // In world coordinates
+    float screenScale;     // Screen pixels per world unit, swing speed is measured on screen
+    bool grabPressed;      // Left mouse button went down
+    bool grabReleased;     // Left mouse button went up
+    bool swapPressed;      // Swap between hand and bat
+    bool skipPressed;      // Skip the logo animation
+} GameInput;
+
+// A point on the mouse path, in screen coordinates
+typedef struct MouseSample {
+    Vector2 position;
+    double time; // Seconds, same clock as GetTime()
+} MouseSample;
+
+extern GameInput input; // global declaration
+
+// Prototypes
+// ----------------------------------------------------------------------------
+void InitInputSampling(void);        // Hook into mouse events, call after the window is created
+void PollGameInput(void);            // Latch input for the current rendered frame
+void SampleMousePath(float delay);   // Set the mouse position to where it was delay seconds before the poll
+void ConsumeGameInput(void);         // Clear one-shot presses after a simulation step
+
+// Recording and replay
+// Input files are a small header (magic, version, seed, pinata wall size)
+// followed by one record per gameplay step: a flags byte, then the mouse
+// position and screen scale only when they changed. Values are in native
+// byte order. The wall size changes the layout and the hits, so a replay
+// only plays out the same with the wall it was recorded with.
+bool StartInputRecording(const char *fileName, unsigned int seed, int wallSize); // Also seeds the random generator
+bool StartInputReplay(const char *fileName, int *wallSize);                      // Seeds the random generator from the file, and gives its wall size
+void StopInputCapture(void);  // Finish recording or replaying
+bool BeginInputStep(void);    // Call before each gameplay step, records or replaces its input, false once the replay has run out
+bool IsInputReplaying(void);  // False once the replay has run out
+
+#endif // SMASHTHEPINATA_INPUT_HEADER_GUARD
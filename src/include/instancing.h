@@ -0,0 +1,39 @@
+// EXPLANATION:
+// Instanced sprite drawing, for candy and other swarms of small sprites
+// DrawTexturePro() rotates each sprite's four corners on the CPU and adds
+// them to raylib's batch. Here every sprite is one instance instead: its
+// position, size, angle and atlas rectangle go into a vertex buffer, and the
+// vertex shader places and rotates a shared quad for each, so any number of
+// sprites from one texture is a single draw call.
+//
+// Needs OpenGL 3.3, or OpenGL ES 3.0 (WebGL 2, raylib built with
+// GRAPHICS_API_OPENGL_ES3). Anywhere else the sprites are drawn one by one
+// with DrawTexturePro(), and look the same.
+
+#ifndef SMASHTHEPINATA_INSTANCING_HEADER_GUARD
+#define SMASHTHEPINATA_INSTANCING_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define SPRITE_INSTANCE_BATCH 4096 // Instances uploaded per draw call, more are drawn in several
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// One sprite, rotated around its center
+typedef struct SpriteInstance {
+    Vector2 position; // Center
+    Vector2 size;
+    Rectangle source; // In the texture, in pixels
+    float angle;      // Degrees, like DrawTexturePro()
+} SpriteInstance;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+bool InitSpriteInstancing(void); // Needs the window (GL context), false if it falls back to DrawTexturePro()
+void UnloadSpriteInstancing(void);
+void DrawSpriteInstances(Texture texture, const SpriteInstance *instances, int count); // All tinted white
+
+#endif // SMASHTHEPINATA_INSTANCING_HEADER_GUARD
@@ -0,0 +1,52 @@
+// EXPLANATION:
+// Work-stealing job system
+// A few worker threads, one per core besides the main thread, run small
+// jobs. Each thread has its own deque of waiting jobs: it pushes and pops
+// its own jobs at the bottom (newest first, still warm in its cache), and
+// when it runs out it steals the oldest job from the top of another
+// thread's deque. Work spreads to idle cores without a shared queue for all
+// threads to fight over, and idle workers sleep on a semaphore.
+//
+// RunJob() and WaitForJobs() fork and join: waiting helps run jobs instead
+// of blocking, so jobs can wait on jobs of their own. ParallelFor() splits a
+// range into jobs and waits for all of them. A thread outside the system (the
+// loader thread) can use it too, with a deque of its own. The main thread
+// never takes jobs from it, a long asset decode would stall a frame.
+//
+// Without threads (the web build), or with no workers, every job runs right
+// away on the calling thread, so callers don't need a fallback of their own.
+
+#ifndef SMASHTHEPINATA_JOBS_HEADER_GUARD
+#define SMASHTHEPINATA_JOBS_HEADER_GUARD
+
+#include <stdbool.h>
+
+// Macros
+// ----------------------------------------------------------------------------
+#define JOB_MAX_WORKERS 8    // Worker threads, besides the main thread
+#define JOB_WORKERS_AUTO -1  // One worker per core, less the main thread's
+#define JOB_QUEUE_SIZE 256   // Jobs waiting per thread, a power of two, more run right away
+#define JOB_SPIN_ROUNDS 64   // Times an idle worker looks for work before it sleeps
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef void (*JobFunc)(void *data);
+typedef void (*ParallelForFunc)(void *data, int start, int end); // Handles items [start, end)
+
+// Jobs started with it that haven't finished, start it at zero
+typedef struct JobCounter {
+    volatile int pending;
+} JobCounter;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+void InitJobSystem(int workerCount); // Or JOB_WORKERS_AUTO, 0 runs every job on the calling thread
+void CloseJobSystem(void);           // Waits for the workers to stop
+int GetJobWorkerCount(void);
+void InitJobThread(void);            // Call first on the one thread outside the system that uses it (the loader)
+
+void RunJob(JobFunc func, void *data, JobCounter *counter); // Fork, counted until it's done
+void WaitForJobs(JobCounter *counter);                       // Join, runs jobs meanwhile
+void ParallelFor(int count, int grainSize, ParallelForFunc func, void *data); // At most grainSize items per job
+
+#endif // SMASHTHEPINATA_JOBS_HEADER_GUARD
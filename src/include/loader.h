@@ -0,0 +1,42 @@
+// EXPLANATION:
+// Loads assets in the background while the logo animation plays
+// Assets are queued first, then decoded (image, font and sound decoding,
+// packing the sprite atlas, breaking sprites into fracture patterns) on a
+// loader thread, which shares them with the job system's workers (see
+// jobs.h) so several decode at once. Anything that needs the GPU or the
+// audio device is finished on the main thread by UpdateAssetLoading(), a few
+// assets per frame within a time budget, so frames keep their pace.
+//
+// Without threads (the web build) UpdateAssetLoading() also decodes, one
+// asset at a time until the frame's decode budget is spent.
+
+#ifndef SMASHTHEPINATA_LOADER_HEADER_GUARD
+#define SMASHTHEPINATA_LOADER_HEADER_GUARD
+
+#include "raylib.h"
+#include "atlas.h"
+#include "fracture.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define LOADER_MAX_ASSETS 32
+#define LOADER_UPLOAD_BUDGET 0.002 // Seconds per frame for main thread work (uploads)
+#define LOADER_DECODE_BUDGET 0.008 // Seconds per frame for decoding, only without a loader thread
+
+// Prototypes
+// ----------------------------------------------------------------------------
+
+// Queue assets, each is written to its destination once loaded
+void QueueFontLoad(Font *font, const char *fileName, int fontSize, int fontType); // FONT_DEFAULT or FONT_SDF
+void QueueSoundLoad(Sound *sound, const char *fileName);
+void QueueWaveLoad(Wave *wave, const char *fileName);    // Only decoded, the caller unloads it
+void QueueMusicLoad(Music *music, const char *fileName); // Streamed, opened on the main thread
+void QueueAtlasLoad(SpriteAtlas *atlas, const char **fileNames, int count);
+void QueueFractureLoad(FracturePattern *pattern, const char *fileName, int pieceCount); // Broken up from the image's alpha mask
+
+void StartAssetLoading(void);   // Start decoding the queued assets
+bool UpdateAssetLoading(void);  // Call every frame, true once everything is loaded
+void StopAssetLoading(void);    // Cancel loading, frees whatever wasn't finished
+float GetAssetLoadingProgress(void); // From 0 to 1
+
+#endif // SMASHTHEPINATA_LOADER_HEADER_GUARD
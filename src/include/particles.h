@@ -0,0 +1,71 @@
+// EXPLANATION:
+// Particle storage and simulation, used for the candy bursts and pinata pieces
+// Particles are stored as separate arrays (structure of arrays) instead of an
+// array of structs, so updating a burst is a few straight loops over
+// contiguous floats that the compiler can vectorize. Big bursts are split
+// into ranges updated on the job system's threads (see jobs.h).
+
+#ifndef SMASHTHEPINATA_PARTICLES_HEADER_GUARD
+#define SMASHTHEPINATA_PARTICLES_HEADER_GUARD
+
+#include "raylib.h"
+#include "allocator.h" // Arena
+
+// Macros
+// ----------------------------------------------------------------------------
+#define PARTICLE_ALIGNMENT 32 // Every array starts on this many bytes
+#define PARTICLE_BATCH 8      // Capacity is rounded up to a multiple of this
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// Integration kernels, the best one available is picked at startup
+// All kernels produce bit-identical results, they only differ in speed
+typedef enum ParticleKernel {
+    PARTICLE_KERNEL_SCALAR,
+    PARTICLE_KERNEL_SSE2,    // x86 baseline
+    PARTICLE_KERNEL_AVX2,    // x86, checked at runtime
+    PARTICLE_KERNEL_NEON,    // ARM
+    PARTICLE_KERNEL_WASM128, // Web build with -msimd128
+    PARTICLE_KERNEL_COUNT
+} ParticleKernel;
+
+typedef struct ParticleSystem {
+    float *positionX;
+    float *positionY;
+    float *prevPositionX; // From the previous simulation step, for interpolation
+    float *prevPositionY;
+    float *velocityX;
+    float *velocityY;
+    float *angle;
+    float *prevAngle;
+    float *rotationRate;
+    int *source;          // Whatever emitted it, for the caller to keep track (0 unless set)
+    unsigned char *textureId;
+
+    int count;    // Particles currently alive, always packed at the front
+    int capacity; // Maximum particles alive at once
+    void *memory; // One allocation backing all the arrays above
+    bool ownsMemory; // False when the memory came from an arena
+} ParticleSystem;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+void InitParticles(ParticleSystem *particles, int capacity, Arena *arena); // Arrays for the given capacity, from the arena or (NULL) the heap
+void FreeParticles(ParticleSystem *particles);
+void ClearParticles(ParticleSystem *particles); // Remove all particles, keeps the memory
+
+// Add one particle, returns its index or -1 when the system is full
+int EmitParticle(ParticleSystem *particles, Vector2 position, Vector2 velocity, float rotationRate, int textureId);
+
+// Advance all particles by one simulation step
+void UpdateParticles(ParticleSystem *particles, float gravity, float deltaTime);
+int RemoveParticlesBelow(ParticleSystem *particles, float bottom); // Falling ones past it, the last takes each one's place, returns how many
+
+// Kernel selection
+ParticleKernel GetBestParticleKernel(void);       // Fastest kernel this CPU and build supports
+bool SetParticleKernel(ParticleKernel kernel);    // Returns false if the kernel isn't supported
+ParticleKernel GetParticleKernel(void);
+const char *GetParticleKernelName(ParticleKernel kernel);
+
+#endif // SMASHTHEPINATA_PARTICLES_HEADER_GUARD
@@ -0,0 +1,73 @@
+// EXPLANATION:
+// Lightweight frame profiler with named zones
+// Wrap code in PROFILE_BEGIN()/PROFILE_END() to time it. Each zone's total
+// time per frame is kept for the last PROFILER_HISTORY frames, and the
+// overlay shows min/avg/p99 for every zone, and for the heap allocations made
+// during each frame. With PROFILER_ENABLED set to 0
+// (see config.h) all the macros compile to nothing.
+//
+// Zones only count on the thread that runs the frames. Work on other threads
+// times itself and is added with PROFILE_ADD() once the frame has waited for it.
+
+#ifndef SMASHTHEPINATA_PROFILER_HEADER_GUARD
+#define SMASHTHEPINATA_PROFILER_HEADER_GUARD
+
+#include "config.h"
+
+#include <stdbool.h>
+
+// Macros
+// ----------------------------------------------------------------------------
+#define PROFILER_HISTORY 240 // Frames of timings kept
+
+#if PROFILER_ENABLED
+    #define PROFILE_FRAME_BEGIN() ProfilerBeginFrame()
+    #define PROFILE_FRAME_END()   ProfilerEndFrame()
+    #define PROFILE_BEGIN(zone)   ProfilerBeginZone(zone)
+    #define PROFILE_END(zone)     ProfilerEndZone(zone)
+    #define PROFILE_ADD(zone, ms) ProfilerAddZoneTime(zone, ms)
+#else
+    #define PROFILE_FRAME_BEGIN() ((void)0)
+    #define PROFILE_FRAME_END()   ((void)0)
+    #define PROFILE_BEGIN(zone)   ((void)0)
+    #define PROFILE_END(zone)     ((void)0)
+    #define PROFILE_ADD(zone, ms) ((void)0)
+#endif
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// Zones may nest, e.g. ZONE_MUSIC runs inside ZONE_UPDATE
+typedef enum ProfileZone {
+    ZONE_FRAME,  // The whole of UpdateDrawFrame()
+    ZONE_LOGO,   // UpdateRaylibLogo()
+    ZONE_LOAD,   // Main thread side of asset loading, see loader.h
+    ZONE_WAIT,   // Waiting for the pipelined simulation (see PIPELINED_SIMULATION in config.h)
+    ZONE_UPDATE, // UpdateGameFrame()
+    ZONE_MUSIC,  // Music streaming
+    ZONE_DRAW,   // DrawGameFrame()
+    ZONE_SWAP,   // EndDrawing(), including the buffer swap and vsync wait
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+typedef struct ProfileStats {
+    float min; // Milliseconds
+    float avg;
+    float p99;
+} ProfileStats;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+void ProfilerBeginFrame(void);
+void ProfilerEndFrame(void);
+void ProfilerBeginZone(ProfileZone zone);
+void ProfilerEndZone(ProfileZone zone);
+void ProfilerAddZoneTime(ProfileZone zone, float milliseconds); // Time measured elsewhere, e.g. on another thread
+bool IsProfilerFrameThread(void);                               // Zones count on this thread, no need to add its time
+
+ProfileStats GetProfileStats(ProfileZone zone); // Over the recorded history
+ProfileStats GetFrameAllocationStats(void);     // Heap allocations per frame (see allocator.h), same history
+double GetProfilerTime(void);                   // High resolution clock in seconds, works without a window
+void DrawProfilerOverlay(int x, int y);         // Draws in screen coordinates
+
+#endif // SMASHTHEPINATA_PROFILER_HEADER_GUARD
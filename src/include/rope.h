@@ -0,0 +1,53 @@
+// EXPLANATION:
+// Verlet rope physics, the strings the pinatas hang from
+// Each rope is a chain of points. A step moves every point by how far it
+// moved last step (Verlet integration, so velocity is implicit) plus
+// gravity, then pulls neighbours back to their segment length a fixed
+// number of times. The first point is pinned where the rope hangs from, the
+// last one carries the load and moves less when pulled.
+//
+// A rope's points are stored together, rope after rope, so updating one
+// touches a few cache lines and only the ropes that move need updating. The
+// fixed iteration count keeps the cost per rope known, however hard a
+// pinata was hit, and ropes are split across job system threads (see jobs.h).
+
+#ifndef SMASHTHEPINATA_ROPE_HEADER_GUARD
+#define SMASHTHEPINATA_ROPE_HEADER_GUARD
+
+#include "raylib.h"
+#include "allocator.h" // Arena
+
+// Macros
+// ----------------------------------------------------------------------------
+#define ROPE_SEGMENTS 6
+#define ROPE_POINTS (ROPE_SEGMENTS + 1)
+#define ROPE_ITERATIONS 6      // Constraint passes per step, more is stiffer
+#define ROPE_DAMPING 0.995f    // Part of the velocity kept every step
+#define ROPE_END_WEIGHT 8.0f   // The load at the end weighs this many rope points
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef struct RopePoint {
+    Vector2 position;
+    Vector2 previous; // Where it was a step ago, also what drawing interpolates from
+} RopePoint;
+
+typedef struct RopeSystem {
+    RopePoint *points;    // ROPE_POINTS per rope, rope after rope
+    float *segmentLength; // Per rope
+    int count;
+    bool ownsMemory;      // False when the memory came from an arena
+} RopeSystem;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+bool InitRopes(RopeSystem *ropes, int count, Arena *arena); // From the arena or (NULL) the heap, false if full
+void FreeRopes(RopeSystem *ropes);
+
+void HangRope(RopeSystem *ropes, int rope, Vector2 anchor, Vector2 end); // Straight and still, pinned at the anchor
+void UpdateRopes(RopeSystem *ropes, const int *indices, int count, float gravity, float deltaTime); // The listed ropes, or the first count with no list
+const RopePoint *GetRopePoints(const RopeSystem *ropes, int rope); // ROPE_POINTS of them, the last is the end
+RopePoint *GetMutableRopePoints(RopeSystem *ropes, int rope);      // The same, to move them by hand
+float GetRopeEndAngle(const RopeSystem *ropes, int rope);          // Degrees the last segment turned from hanging straight down
+
+#endif // SMASHTHEPINATA_ROPE_HEADER_GUARD
@@ -0,0 +1,50 @@
+// EXPLANATION:
+// Procedural sound effects, synthesized on the audio thread
+// The swing whoosh is filtered white noise, generated in an audio stream
+// callback: a band-pass filter's cutoff follows the swing speed, so faster
+// swings sound higher, and its gain fades in with speed. There's no sample
+// to load or resample, and the callback smooths every parameter change per
+// sample, so the sound follows the swing without steps.
+//
+// Short samples (the hit sounds) are mixed into the same stream. The game
+// thread never takes raylib's audio lock for these: parameter changes and
+// sample triggers go to the callback through a lock-free single producer,
+// single consumer queue. Each message carries the time it's meant for (see
+// stepTime in game.h) and the callback applies it at that exact frame,
+// SYNTH_SCHEDULE_DELAY later, so sounds keep the simulation's timing instead
+// of snapping to whenever the next audio buffer happens to be mixed.
+
+#ifndef SMASHTHEPINATA_SYNTH_HEADER_GUARD
+#define SMASHTHEPINATA_SYNTH_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define SYNTH_SAMPLE_RATE 44100
+#define SYNTH_BUFFER_FRAMES 512     // Frames per audio stream buffer, lower means less latency
+#define SYNTH_SMOOTHING_TIME 0.03f  // Seconds for parameters to (mostly) reach a new target
+#define SYNTH_QUEUE_SIZE 256        // Messages in flight to the callback, a power of two
+#define SYNTH_MAX_VOICES 8          // Samples playing at once, the oldest is cut off
+#define SYNTH_SCHEDULE_DELAY 0.03   // Seconds from a message's time to when it's heard, covers
+                                    // a rendered frame plus a buffer, later messages play late
+
+#define WHOOSH_CUTOFF 300.0f        // Band-pass center at pitch 1, in Hz
+#define WHOOSH_RESONANCE 1.5f       // Band-pass Q, higher is more tonal
+#define WHOOSH_LEVEL 1.1f           // Output gain at volume 1, about the old whoosh sample's loudness
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef enum { SYNTH_SAMPLE_HIT, SYNTH_SAMPLE_BONK, SYNTH_SAMPLE_COUNT } SynthSample;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+void LoadSynthSample(SynthSample sample, Wave wave); // Takes over the wave, call before StartSynth()
+void StartSynth(void); // Needs the audio device
+void StopSynth(void);  // Also unloads the samples
+
+// Game thread only (whichever runs the simulation steps), time is on the GetProfilerTime() clock
+void SetWhoosh(float volume, float pitch, double time); // Pitch scales the cutoff
+void PlaySynthSample(SynthSample sample, float volume, double time);
+
+#endif // SMASHTHEPINATA_SYNTH_HEADER_GUARD
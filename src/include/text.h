@@ -0,0 +1,57 @@
+// EXPLANATION:
+// Cached text layout
+// Measuring and drawing text with raylib walks every codepoint and looks up
+// its glyph each time. Labels that don't change between frames are laid out
+// once instead: the cache keeps each (font, text, size, spacing) with its
+// measured size and ready-made glyph quads, and drawing one is a single run
+// of quads in raylib's batch. A layout is only built again when its text
+// changes (or it fell out of the cache).
+//
+// Fonts can also be loaded as signed distance fields (FONT_SDF): each glyph
+// stores the distance to its outline instead of coverage, and the SDF shader
+// turns that back into a sharp edge at whatever size it's drawn. One small
+// atlas then serves every text size, crisp even when scaled up at 4K.
+
+#ifndef SMASHTHEPINATA_TEXT_HEADER_GUARD
+#define SMASHTHEPINATA_TEXT_HEADER_GUARD
+
+#include "raylib.h"
+
+// Macros
+// ----------------------------------------------------------------------------
+#define TEXT_CACHE_SIZE 16  // Layouts kept, the least recently used one is replaced
+#define TEXT_MAX_LENGTH 64  // Bytes of text per layout, longer text is cut short
+#define TEXT_SDF_FONT_SIZE 48 // Glyph size in SDF font atlases, plenty for any drawn size
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+// A glyph's quad, relative to the text's top left corner
+typedef struct TextGlyph {
+    Rectangle source;      // In the font's texture
+    Rectangle destination;
+} TextGlyph;
+
+typedef struct TextLayout {
+    char text[TEXT_MAX_LENGTH];
+    unsigned int fontId;   // Font texture, different fonts never share a layout
+    float fontSize;
+    float spacing;
+    Vector2 size;          // Same as MeasureTextEx()
+    TextGlyph glyphs[TEXT_MAX_LENGTH];
+    int glyphCount;
+    unsigned int lastUsed;
+} TextLayout;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+
+// Single line text only, like DrawTextEx() without newlines
+const TextLayout *GetTextLayout(Font font, const char *text, float fontSize, float spacing); // Cached or laid out now
+void DrawTextLayout(const TextLayout *layout, Font font, Vector2 position, Color tint);
+void ClearTextCache(void); // Call when a font is unloaded
+
+// Draw SDF fonts between BeginShaderMode(sdfShader) and EndShaderMode()
+Shader LoadSdfShader(void); // Needs the window (GL context)
+
+#endif // SMASHTHEPINATA_TEXT_HEADER_GUARD
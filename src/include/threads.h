@@ -0,0 +1,132 @@
+// EXPLANATION:
+// Minimal threads and atomics over pthreads and Win32
+// Only what the game needs: start a thread, wait for it to finish, a
+// semaphore for idle threads to sleep on, and a few atomic operations on ints
+// (and 64-bit counters) to hand work between threads without locks.
+//
+// The web build has no threads (they'd need cross-origin isolation headers
+// the hosting can't set), there StartThread() always fails and callers fall
+// back to doing the work on the main thread.
+
+#ifndef SMASHTHEPINATA_THREADS_HEADER_GUARD
+#define SMASHTHEPINATA_THREADS_HEADER_GUARD
+
+#include <stdbool.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h> // _Interlocked* functions
+#endif
+
+// Macros
+// ----------------------------------------------------------------------------
+#if defined(_MSC_VER)
+    #define THREAD_LOCAL __declspec(thread) // One copy of the variable per thread
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef int (*ThreadFunc)(void *arg);
+
+typedef struct Thread {
+    unsigned char handle[16]; // pthread_t or a Win32 HANDLE
+    bool started;
+} Thread;
+
+typedef struct Semaphore {
+    long long handle[24]; // pthread mutex, condition and count, or a Win32 HANDLE
+} Semaphore;
+
+// Prototypes
+// ----------------------------------------------------------------------------
+bool StartThread(Thread *thread, ThreadFunc func, void *arg); // False if threads aren't available
+void JoinThread(Thread *thread);                              // Wait for the thread to return
+bool AreThreadsAvailable(void);
+int GetCpuCount(void);                                        // Logical cores, 1 without threads
+void YieldThread(void);                                       // Let another thread run
+
+void InitSemaphore(Semaphore *semaphore);                     // Starts at 0
+void DestroySemaphore(Semaphore *semaphore);
+void PostSemaphore(Semaphore *semaphore, int count);          // Wakes up to count waiting threads
+void WaitSemaphore(Semaphore *semaphore);                     // Sleeps until posted
+
+// Atomics
+// ----------------------------------------------------------------------------
+// Loads acquire and stores release: writes made before a store are visible
+// to a thread once it loads the stored value.
+
+static inline int AtomicLoad(volatile int *value)
+{
+#if defined(_MSC_VER)
+    return (int)_InterlockedOr((volatile long *)value, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void AtomicStore(volatile int *value, int newValue)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchange((volatile long *)value, (long)newValue);
+#else
+    __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline int AtomicAdd(volatile int *value, int amount) // Returns the new value
+{
+#if defined(_MSC_VER)
+    return (int)_InterlockedExchangeAdd((volatile long *)value, (long)amount) + amount;
+#else
+    return __atomic_add_fetch(value, amount, __ATOMIC_ACQ_REL);
+#endif
+}
+
+static inline bool AtomicCompareExchange(volatile int *value, int expected, int desired) // True if swapped
+{
+#if defined(_MSC_VER)
+    return (_InterlockedCompareExchange((volatile long *)value, (long)desired, (long)expected) == expected);
+#else
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline long long AtomicLoad64(volatile long long *value)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    return _InterlockedOr64(value, 0);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange64(value, 0, 0); // 32-bit has no 64-bit or, swapping 0 for 0 reads it
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline long long AtomicAdd64(volatile long long *value, long long amount) // Returns the new value
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    return _InterlockedExchangeAdd64(value, amount) + amount;
+#elif defined(_MSC_VER)
+    long long old = *value; // 32-bit has no 64-bit add, retry until nothing changed it in between
+    for (;;)
+    {
+        long long seen = _InterlockedCompareExchange64(value, old + amount, old);
+        if (seen == old) return old + amount;
+        old = seen;
+    }
+#else
+    return __atomic_add_fetch(value, amount, __ATOMIC_ACQ_REL);
+#endif
+}
+
+static inline bool AtomicCompareExchange64(volatile long long *value, long long expected, long long desired) // True if swapped
+{
+#if defined(_MSC_VER)
+    return (_InterlockedCompareExchange64(value, desired, expected) == expected);
+#else
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+#endif // SMASHTHEPINATA_THREADS_HEADER_GUARD
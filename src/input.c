@@ -0,0 +1,351 @@
+// EXPLANATION:
+// Player input, latched once per rendered frame
+// See input.h for more documentation/descriptions
+
+#include "input.h"
+#include "game.h"
+
+#include <stdio.h>  // FILE
+#include <string.h> // memcmp
+
+#if defined(PLATFORM_WEB)
+    #include <emscripten/emscripten.h>
+#else
+    // raylib's GLFW on desktop, declared by hand to chain its cursor callback
+    typedef struct GLFWwindow GLFWwindow;
+    typedef void (*GLFWcursorposfun)(GLFWwindow *window, double x, double y);
+    GLFWcursorposfun glfwSetCursorPosCallback(GLFWwindow *window, GLFWcursorposfun callback);
+#endif
+
+// Flags byte at the start of every recorded step
+#define RECORD_GRAB_PRESSED  (1 << 0)
+#define RECORD_GRAB_RELEASED (1 << 1)
+#define RECORD_SWAP_PRESSED  (1 << 2)
+#define RECORD_SKIP_PRESSED  (1 << 3)
+#define RECORD_MOVED         (1 << 4) // Mouse position follows
+#define RECORD_SCALED        (1 << 5) // Screen scale follows
+
+typedef enum { INPUT_LIVE, INPUT_RECORDING, INPUT_REPLAYING } InputSource;
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void WriteInputRecord(void);
+static bool ReadInputRecord(void);
+static void PushMouseSample(Vector2 position, double time);
+static void CollectMouseSamples(double now);
+
+// Global input state
+GameInput input = { 0 };
+
+// Recording and replay state
+static InputSource inputSource = INPUT_LIVE;
+static FILE *inputFile = NULL;
+static unsigned int recordedSteps;
+static GameInput lastRecord; // Unchanged values aren't written again
+
+// Mouse path, a ring of the latest samples
+static MouseSample mouseSamples[INPUT_MAX_MOUSE_SAMPLES];
+static int newestSample = -1;
+static int sampleCount = 0;
+static int unstampedSamples = 0; // Samples waiting for a time, see CollectMouseSamples()
+static double lastPollTime = 0.0;
+
+#if defined(PLATFORM_WEB)
+// Pointer events carry the time they happened, and coalesced events hold
+// every sample the browser merged into one event. They're kept in canvas
+// pixels, the same coordinates raylib's mouse position uses.
+EM_JS(void, InstallPointerListener, (void), {
+    var canvas = Module['canvas'];
+    Module.pointerSamples = [];
+    canvas.addEventListener('pointermove', function(event) {
+        var rect = canvas.getBoundingClientRect();
+        var events = (event.getCoalescedEvents)? event.getCoalescedEvents() : [];
+        if (events.length == 0) events = [event];
+        for (var i = 0; i < events.length; i++) {
+            Module.pointerSamples.push((events[i].clientX - rect.left)*canvas.width/rect.width,
+                                       (events[i].clientY - rect.top)*canvas.height/rect.height,
+                                       events[i].timeStamp);
+        }
+    });
+});
+
+// Writes x, y and age in seconds for each sample, returns how many
+EM_JS(int, DrainPointerSamples, (float *buffer, int maxSamples), {
+    var samples = Module.pointerSamples;
+    var count = Math.min(samples.length/3, maxSamples);
+    var first = samples.length/3 - count;
+    var now = performance.now();
+    for (var i = 0; i < count; i++) {
+        HEAPF32[(buffer >> 2) + i*3 + 0] = samples[(first + i)*3 + 0];
+        HEAPF32[(buffer >> 2) + i*3 + 1] = samples[(first + i)*3 + 1];
+        HEAPF32[(buffer >> 2) + i*3 + 2] = (now - samples[(first + i)*3 + 2])/1000;
+    }
+    samples.length = 0;
+    return count;
+});
+#else
+static GLFWcursorposfun raylibCursorCallback = NULL;
+
+// GLFW reports every cursor movement, but only while raylib polls events
+// once per frame, so samples get their time in CollectMouseSamples()
+static void CursorPosCallback(GLFWwindow *window, double x, double y)
+{
+    PushMouseSample((Vector2){ (float)x, (float)y }, 0.0);
+    unstampedSamples++;
+    if (raylibCursorCallback != NULL) raylibCursorCallback(window, x, y);
+}
+#endif
+
+// Mouse sampling
+// ----------------------------------------------------------------------------
+
+void InitInputSampling(void)
+{
+#if defined(PLATFORM_WEB)
+    InstallPointerListener();
+#else
+    raylibCursorCallback = glfwSetCursorPosCallback(GetWindowHandle(), CursorPosCallback);
+#endif
+    lastPollTime = GetTime();
+}
+
+void PollGameInput(void)
+{
+    double now = GetTime();
+    CollectMouseSamples(now);
+    lastPollTime = now;
+
+    input.mousePosition = GetScreenToWorld2D(mouseSamples[newestSample].position, camera);
+    input.screenScale = camera.zoom;
+
+    // Presses accumulate until a simulation step consumes them
+    input.grabPressed  |= IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    input.grabReleased |= IsMouseButtonReleased(MOUSE_LEFT_BUTTON);
+    input.swapPressed  |= IsKeyPressed(KEY_SPACE);
+
+    // Press key or click or touch to skip (but not while using a shortcut)
+    bool modifierDown = IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT) ||
+                        IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT) ||
+                        IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    if (!modifierDown && ((GetKeyPressed() != KEY_NULL) || IsGestureDetected(GESTURE_TAP)))
+        input.skipPressed = true;
+}
+
+void SampleMousePath(float delay)
+{
+    if (sampleCount == 0) return;
+
+    // Newest sample at or before the time, then blend towards the next one
+    double time = lastPollTime - delay;
+    int index = newestSample;
+    int age = 0;
+    while ((age < sampleCount - 1) && (mouseSamples[index].time > time))
+    {
+        index = (index + INPUT_MAX_MOUSE_SAMPLES - 1)%INPUT_MAX_MOUSE_SAMPLES;
+        age++;
+    }
+
+    Vector2 position = mouseSamples[index].position;
+    if ((age > 0) && (mouseSamples[index].time <= time))
+    {
+        MouseSample next = mouseSamples[(index + 1)%INPUT_MAX_MOUSE_SAMPLES];
+        double span = next.time - mouseSamples[index].time;
+        float t = (span > 0.0)? (float)((time - mouseSamples[index].time)/span) : 1.0f;
+        position.x += (next.position.x - position.x)*t;
+        position.y += (next.position.y - position.y)*t;
+    }
+
+    input.mousePosition = GetScreenToWorld2D(position, camera);
+}
+
+void ConsumeGameInput(void)
+{
+    input.grabPressed  = false;
+    input.grabReleased = false;
+    input.swapPressed  = false;
+    input.skipPressed  = false;
+}
+
+static void PushMouseSample(Vector2 position, double time)
+{
+    newestSample = (newestSample + 1)%INPUT_MAX_MOUSE_SAMPLES;
+    mouseSamples[newestSample] = (MouseSample){ position, time };
+    if (sampleCount < INPUT_MAX_MOUSE_SAMPLES) sampleCount++;
+}
+
+static void CollectMouseSamples(double now)
+{
+    int newSamples = 0;
+
+#if defined(PLATFORM_WEB)
+    float buffer[INPUT_MAX_MOUSE_SAMPLES*3];
+    newSamples = DrainPointerSamples(buffer, INPUT_MAX_MOUSE_SAMPLES);
+    for (int i = 0; i < newSamples; i++)
+    {
+        double time = now - buffer[i*3 + 2];
+        if (time < lastPollTime) time = lastPollTime; // Keep the path in order
+        PushMouseSample((Vector2){ buffer[i*3 + 0], buffer[i*3 + 1] }, time);
+    }
+#else
+    // Events from one poll happened some time since the last poll, in order,
+    // spread them evenly over that time
+    if (unstampedSamples > INPUT_MAX_MOUSE_SAMPLES) unstampedSamples = INPUT_MAX_MOUSE_SAMPLES;
+    newSamples = unstampedSamples;
+    for (int i = 0; i < unstampedSamples; i++)
+    {
+        int index = (newestSample - i + INPUT_MAX_MOUSE_SAMPLES)%INPUT_MAX_MOUSE_SAMPLES;
+        mouseSamples[index].time = now - (now - lastPollTime)*i/unstampedSamples;
+    }
+    unstampedSamples = 0;
+#endif
+
+    // Touch input and platforms without mouse events only have the position
+    // at the poll, add it when it moved
+    Vector2 position = GetMousePosition();
+    bool moved = (sampleCount == 0) || (position.x != mouseSamples[newestSample].position.x) ||
+                 (position.y != mouseSamples[newestSample].position.y);
+    if ((newSamples == 0) && moved) PushMouseSample(position, now);
+}
+
+// Recording and replay
+// ----------------------------------------------------------------------------
+
+bool StartInputRecording(const char *fileName, unsigned int seed, int wallSize)
+{
+    StopInputCapture();
+    inputFile = fopen(fileName, "wb");
+    if (inputFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "INPUT: [%s] Failed to open file for recording", fileName);
+        return false;
+    }
+
+    unsigned int version = INPUT_FILE_VERSION;
+    fwrite(INPUT_FILE_MAGIC, 1, 4, inputFile);
+    fwrite(&version, sizeof(version), 1, inputFile);
+    fwrite(&seed, sizeof(seed), 1, inputFile);
+    fwrite(&wallSize, sizeof(wallSize), 1, inputFile);
+
+    SetRandomSeed(seed);
+    inputSource = INPUT_RECORDING;
+    recordedSteps = 0;
+    lastRecord = (GameInput){ 0 };
+    TraceLog(LOG_INFO, "INPUT: [%s] Recording input, seed %u, wall of %i", fileName, seed, wallSize);
+    return true;
+}
+
+bool StartInputReplay(const char *fileName, int *wallSize)
+{
+    StopInputCapture();
+    inputFile = fopen(fileName, "rb");
+    if (inputFile == NULL)
+    {
+        TraceLog(LOG_WARNING, "INPUT: [%s] Failed to open file for replay", fileName);
+        return false;
+    }
+
+    char magic[4];
+    unsigned int version = 0;
+    unsigned int seed = 0;
+    int recordedWallSize = 0;
+    bool valid = (fread(magic, 1, 4, inputFile) == 4) && (memcmp(magic, INPUT_FILE_MAGIC, 4) == 0) &&
+                 (fread(&version, sizeof(version), 1, inputFile) == 1) && (version == INPUT_FILE_VERSION) &&
+                 (fread(&seed, sizeof(seed), 1, inputFile) == 1) &&
+                 (fread(&recordedWallSize, sizeof(recordedWallSize), 1, inputFile) == 1);
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "INPUT: [%s] Not a version %i input file", fileName, INPUT_FILE_VERSION);
+        fclose(inputFile);
+        inputFile = NULL;
+        return false;
+    }
+
+    SetRandomSeed(seed);
+    *wallSize = recordedWallSize;
+    inputSource = INPUT_REPLAYING;
+    recordedSteps = 0;
+    lastRecord = (GameInput){ 0 };
+    TraceLog(LOG_INFO, "INPUT: [%s] Replaying input, seed %u, wall of %i", fileName, seed, recordedWallSize);
+    return true;
+}
+
+void StopInputCapture(void)
+{
+    if (inputFile == NULL) return;
+
+    if (inputSource == INPUT_RECORDING)
+        TraceLog(LOG_INFO, "INPUT: Recorded %u steps", recordedSteps);
+    else
+        TraceLog(LOG_INFO, "INPUT: Replayed %u steps", recordedSteps);
+
+    fclose(inputFile);
+    inputFile = NULL;
+    inputSource = INPUT_LIVE;
+}
+
+bool BeginInputStep(void)
+{
+    if (inputSource == INPUT_RECORDING)
+    {
+        WriteInputRecord();
+    }
+    else if (inputSource == INPUT_REPLAYING)
+    {
+        if (!ReadInputRecord())
+        {
+            StopInputCapture();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool IsInputReplaying(void)
+{
+    return (inputSource == INPUT_REPLAYING);
+}
+
+static void WriteInputRecord(void)
+{
+    unsigned char flags = 0;
+    if (input.grabPressed)  flags |= RECORD_GRAB_PRESSED;
+    if (input.grabReleased) flags |= RECORD_GRAB_RELEASED;
+    if (input.swapPressed)  flags |= RECORD_SWAP_PRESSED;
+    if (input.skipPressed)  flags |= RECORD_SKIP_PRESSED;
+    bool moved = (recordedSteps == 0) ||
+                 (input.mousePosition.x != lastRecord.mousePosition.x) ||
+                 (input.mousePosition.y != lastRecord.mousePosition.y);
+    bool scaled = (recordedSteps == 0) || (input.screenScale != lastRecord.screenScale);
+    if (moved)  flags |= RECORD_MOVED;
+    if (scaled) flags |= RECORD_SCALED;
+
+    fwrite(&flags, 1, 1, inputFile);
+    if (moved)  fwrite(&input.mousePosition, sizeof(Vector2), 1, inputFile);
+    if (scaled) fwrite(&input.screenScale, sizeof(float), 1, inputFile);
+
+    lastRecord = input;
+    recordedSteps++;
+}
+
+static bool ReadInputRecord(void)
+{
+    unsigned char flags;
+    if (fread(&flags, 1, 1, inputFile) != 1)
+        return false;
+
+    GameInput record = lastRecord;
+    record.grabPressed  = (flags & RECORD_GRAB_PRESSED) != 0;
+    record.grabReleased = (flags & RECORD_GRAB_RELEASED) != 0;
+    record.swapPressed  = (flags & RECORD_SWAP_PRESSED) != 0;
+    record.skipPressed  = (flags & RECORD_SKIP_PRESSED) != 0;
+    if ((flags & RECORD_MOVED) && (fread(&record.mousePosition, sizeof(Vector2), 1, inputFile) != 1))
+        return false;
+    if ((flags & RECORD_SCALED) && (fread(&record.screenScale, sizeof(float), 1, inputFile) != 1))
+        return false;
+
+    input = record;
+    lastRecord = record;
+    recordedSteps++;
+    return true;
+}
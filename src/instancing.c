@@ -0,0 +1,181 @@
+// EXPLANATION:
+// Instanced sprite drawing, for candy and other swarms of small sprites
+// See instancing.h for more documentation/descriptions
+
+#include "instancing.h"
+#include "atlas.h"
+#include "rlgl.h"
+#include "raymath.h"
+
+#include <stddef.h> // offsetof
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void DrawSpritesOneByOne(Texture texture, const SpriteInstance *instances, int count);
+
+// Each vertex is a corner of the shared quad, the instance attributes say
+// where that quad goes and which part of the texture it shows
+#if defined(PLATFORM_WEB)
+    #define INSTANCING_GLSL_VERSION "#version 300 es\n"
+#else
+    #define INSTANCING_GLSL_VERSION "#version 330\n"
+#endif
+
+static const char *instancingVertexShader =
+    INSTANCING_GLSL_VERSION
+    "in vec2 vertexPosition;\n"    // -0.5 to 0.5
+    "in vec4 instanceBounds;\n"    // Center, size
+    "in vec4 instanceSource;\n"    // Texture rectangle, in pixels
+    "in float instanceAngle;\n"    // Degrees
+    "uniform mat4 mvp;\n"
+    "uniform vec2 textureSize;\n"
+    "out vec2 fragTexCoord;\n"
+    "void main()\n"
+    "{\n"
+    "    float angle = radians(instanceAngle);\n"
+    "    vec2 corner = vertexPosition*instanceBounds.zw;\n"
+    "    vec2 rotated = vec2(corner.x*cos(angle) - corner.y*sin(angle), corner.x*sin(angle) + corner.y*cos(angle));\n"
+    "    fragTexCoord = (instanceSource.xy + (vertexPosition + 0.5)*instanceSource.zw)/textureSize;\n"
+    "    gl_Position = mvp*vec4(instanceBounds.xy + rotated, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *instancingFragmentShader =
+    INSTANCING_GLSL_VERSION
+    "precision mediump float;\n"    // Plenty for colors of 8 bits per channel, and ES has no default here
+    "in highp vec2 fragTexCoord;\n" // Texel exact across a 4096 atlas, more than mediump's 10 bits
+    "uniform sampler2D texture0;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(texture0, fragTexCoord);\n"
+    "}\n";
+
+// Two triangles, same winding as raylib's quads
+static const float quadCorners[12] = {
+    -0.5f, -0.5f,  -0.5f, 0.5f,  0.5f, 0.5f,
+    -0.5f, -0.5f,   0.5f, 0.5f,  0.5f, -0.5f,
+};
+
+// Instancing state, zero when falling back
+static Shader instancingShader = { 0 };
+static unsigned int vertexArray = 0;
+static unsigned int quadBuffer = 0;
+static unsigned int instanceBuffer = 0;
+static int textureSizeLocation = -1;
+
+// Setup
+// ----------------------------------------------------------------------------
+
+bool InitSpriteInstancing(void)
+{
+    int version = rlGetVersion();
+    if ((version != RL_OPENGL_33) && (version != RL_OPENGL_43) && (version != RL_OPENGL_ES_30))
+    {
+        TraceLog(LOG_INFO, "INSTANCING: Not supported by this OpenGL version, sprites are drawn one by one");
+        return false;
+    }
+
+    instancingShader = LoadShaderFromMemory(instancingVertexShader, instancingFragmentShader);
+    if (!IsShaderValid(instancingShader)) return false;
+
+    int boundsLocation = rlGetLocationAttrib(instancingShader.id, "instanceBounds");
+    int sourceLocation = rlGetLocationAttrib(instancingShader.id, "instanceSource");
+    int angleLocation = rlGetLocationAttrib(instancingShader.id, "instanceAngle");
+    textureSizeLocation = GetShaderLocation(instancingShader, "textureSize");
+    if ((boundsLocation < 0) || (sourceLocation < 0) || (angleLocation < 0))
+    {
+        UnloadSpriteInstancing();
+        return false;
+    }
+
+    vertexArray = rlLoadVertexArray();
+    rlEnableVertexArray(vertexArray);
+
+    // Per vertex, the quad's corners
+    quadBuffer = rlLoadVertexBuffer(quadCorners, sizeof(quadCorners), false);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+
+    // Per instance, filled on every draw
+    int stride = sizeof(SpriteInstance);
+    instanceBuffer = rlLoadVertexBuffer(NULL, SPRITE_INSTANCE_BATCH*stride, true);
+    rlSetVertexAttribute(boundsLocation, 4, RL_FLOAT, false, stride, offsetof(SpriteInstance, position));
+    rlSetVertexAttribute(sourceLocation, 4, RL_FLOAT, false, stride, offsetof(SpriteInstance, source));
+    rlSetVertexAttribute(angleLocation, 1, RL_FLOAT, false, stride, offsetof(SpriteInstance, angle));
+    rlSetVertexAttributeDivisor(boundsLocation, 1);
+    rlSetVertexAttributeDivisor(sourceLocation, 1);
+    rlSetVertexAttributeDivisor(angleLocation, 1);
+    rlEnableVertexAttribute(boundsLocation);
+    rlEnableVertexAttribute(sourceLocation);
+    rlEnableVertexAttribute(angleLocation);
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+
+    TraceLog(LOG_INFO, "INSTANCING: Sprites are drawn instanced, %i per draw call", SPRITE_INSTANCE_BATCH);
+    return true;
+}
+
+void UnloadSpriteInstancing(void)
+{
+    if (instanceBuffer != 0) rlUnloadVertexBuffer(instanceBuffer);
+    if (quadBuffer != 0) rlUnloadVertexBuffer(quadBuffer);
+    if (vertexArray != 0) rlUnloadVertexArray(vertexArray);
+    if (instancingShader.id != 0) UnloadShader(instancingShader);
+
+    instancingShader = (Shader){ 0 };
+    vertexArray = quadBuffer = instanceBuffer = 0;
+}
+
+// Draw
+// ----------------------------------------------------------------------------
+
+void DrawSpriteInstances(Texture texture, const SpriteInstance *instances, int count)
+{
+    if (count <= 0) return;
+    if (vertexArray == 0)
+    {
+        DrawSpritesOneByOne(texture, instances, count);
+        return;
+    }
+
+    // Whatever raylib has batched so far goes first, so the order stays
+    rlDrawRenderBatchActive();
+    TrackDrawCall();
+
+    // Same transform raylib's batch is drawn with, camera included
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    float textureSize[2] = { (float)texture.width, (float)texture.height };
+    int textureSlot = 0;
+
+    rlEnableShader(instancingShader.id);
+    rlSetUniformMatrix(instancingShader.locs[SHADER_LOC_MATRIX_MVP], mvp);
+    rlSetUniform(textureSizeLocation, textureSize, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(instancingShader.locs[SHADER_LOC_MAP_DIFFUSE], &textureSlot, RL_SHADER_UNIFORM_SAMPLER2D, 1);
+    rlActiveTextureSlot(0);
+    rlEnableTexture(texture.id);
+    rlEnableVertexArray(vertexArray);
+
+    for (int first = 0; first < count; first += SPRITE_INSTANCE_BATCH)
+    {
+        int batch = (count - first < SPRITE_INSTANCE_BATCH)? count - first : SPRITE_INSTANCE_BATCH;
+        rlUpdateVertexBuffer(instanceBuffer, instances + first, batch*(int)sizeof(SpriteInstance), 0);
+        rlDrawVertexArrayInstanced(0, 6, batch);
+    }
+
+    rlDisableVertexArray();
+    rlDisableTexture();
+    rlDisableShader();
+}
+
+static void DrawSpritesOneByOne(Texture texture, const SpriteInstance *instances, int count)
+{
+    TrackDrawTexture(texture);
+    for (int i = 0; i < count; i++)
+    {
+        SpriteInstance instance = instances[i];
+        Rectangle destination = { instance.position.x, instance.position.y, instance.size.x, instance.size.y };
+        Vector2 origin = { instance.size.x/2.0f, instance.size.y/2.0f };
+        DrawTexturePro(texture, instance.source, destination, origin, instance.angle, WHITE);
+    }
+}
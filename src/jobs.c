@@ -0,0 +1,249 @@
+// EXPLANATION:
+// Work-stealing job system
+// See jobs.h for more documentation/descriptions
+
+#include "jobs.h"
+#include "threads.h"
+#include "raylib.h" // TraceLog
+
+#include <stddef.h> // NULL
+#include <stdint.h> // intptr_t
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef struct Job {
+    JobFunc func;              // Either this,
+    ParallelForFunc rangeFunc; // or this over [start, end)
+    void *data;
+    int start;
+    int end;
+    JobCounter *counter;
+} Job;
+
+// Jobs waiting on one thread. The lock is only held to copy a job in or out,
+// and thieves rarely pick the same deque as its owner at the same moment.
+typedef struct JobDeque {
+    volatile int lock;
+    volatile int top;    // Oldest job, thieves take from here
+    volatile int bottom; // Newest job, the owner pushes and pops here
+    // Both only change under the lock, but are read without it to skip empty deques
+    Job jobs[JOB_QUEUE_SIZE];
+} JobDeque;
+
+#define JOB_OUTSIDE_DEQUE (JOB_MAX_WORKERS + 1) // Of the thread that called InitJobThread()
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static int RunWorker(void *arg);
+static bool PushJob(Job job);
+static bool FindJob(Job *job);
+static void RunJobNow(Job *job);
+static void LockDeque(JobDeque *deque);
+static void UnlockDeque(JobDeque *deque);
+
+// Job system state
+static JobDeque deques[JOB_OUTSIDE_DEQUE + 1]; // 0 is the main thread's, workers have the rest but the last
+static Thread workers[JOB_MAX_WORKERS];
+static volatile int workerCount = 0;        // Grows while workers start, they read it
+static volatile int workersRunning = 0;
+static Semaphore wakeup;                     // Posted for new jobs, idle workers wait on it
+static THREAD_LOCAL int threadIndex = 0;     // This thread's deque
+
+// Setup
+// ----------------------------------------------------------------------------
+
+void InitJobSystem(int count)
+{
+    if (count == JOB_WORKERS_AUTO) count = GetCpuCount() - 1;
+    if (count > JOB_MAX_WORKERS) count = JOB_MAX_WORKERS;
+    if ((count < 0) || !AreThreadsAvailable()) count = 0;
+
+    for (int i = 0; i <= JOB_OUTSIDE_DEQUE; i++)
+        deques[i] = (JobDeque){ 0 };
+
+    InitSemaphore(&wakeup);
+    AtomicStore(&workersRunning, 1);
+    AtomicStore(&workerCount, 0);
+    for (int i = 0; i < count; i++)
+    {
+        if (!StartThread(&workers[i], RunWorker, (void *)(intptr_t)(i + 1))) break;
+        AtomicAdd(&workerCount, 1);
+    }
+
+    TraceLog(LOG_INFO, "JOBS: %i worker threads", workerCount);
+}
+
+void CloseJobSystem(void)
+{
+    AtomicStore(&workersRunning, 0);
+    PostSemaphore(&wakeup, workerCount);
+    for (int i = 0; i < workerCount; i++)
+        JoinThread(&workers[i]);
+
+    DestroySemaphore(&wakeup);
+    AtomicStore(&workerCount, 0);
+}
+
+int GetJobWorkerCount(void)
+{
+    return workerCount;
+}
+
+void InitJobThread(void)
+{
+    threadIndex = JOB_OUTSIDE_DEQUE;
+}
+
+static int RunWorker(void *arg)
+{
+    threadIndex = (int)(intptr_t)arg;
+
+    while (AtomicLoad(&workersRunning))
+    {
+        // Look around for a while before sleeping, jobs tend to come in bursts
+        Job job;
+        bool found = false;
+        for (int i = 0; (i < JOB_SPIN_ROUNDS) && !found; i++)
+        {
+            found = FindJob(&job);
+            if (!found) YieldThread();
+        }
+
+        if (found) RunJobNow(&job);
+        else WaitSemaphore(&wakeup);
+    }
+
+    return 0;
+}
+
+// Fork and join
+// ----------------------------------------------------------------------------
+
+void RunJob(JobFunc func, void *data, JobCounter *counter)
+{
+    Job job = { .func = func, .data = data, .counter = counter };
+    if (counter != NULL) AtomicAdd(&counter->pending, 1);
+
+    if ((workerCount > 0) && PushJob(job)) PostSemaphore(&wakeup, 1);
+    else RunJobNow(&job); // Nobody else to run it, or this thread's deque is full
+}
+
+void WaitForJobs(JobCounter *counter)
+{
+    while (AtomicLoad(&counter->pending) > 0)
+    {
+        Job job;
+        if (FindJob(&job)) RunJobNow(&job);
+        else YieldThread(); // The last jobs are running on other threads
+    }
+}
+
+void ParallelFor(int count, int grainSize, ParallelForFunc func, void *data)
+{
+    if (count <= 0) return;
+    if (grainSize < 1) grainSize = 1;
+    if ((workerCount == 0) || (count <= grainSize))
+    {
+        func(data, 0, count);
+        return;
+    }
+
+    // Queue all but the first piece, then work on that one here
+    JobCounter counter = { 0 };
+    int queued = 0;
+    for (int start = grainSize; start < count; start += grainSize)
+    {
+        int end = (count - start < grainSize)? count : start + grainSize;
+        Job job = { .rangeFunc = func, .data = data, .start = start, .end = end, .counter = &counter };
+        AtomicAdd(&counter.pending, 1);
+        if (PushJob(job)) queued++;
+        else RunJobNow(&job);
+    }
+
+    PostSemaphore(&wakeup, (queued < workerCount)? queued : workerCount);
+    func(data, 0, grainSize);
+    WaitForJobs(&counter);
+}
+
+// Deques
+// ----------------------------------------------------------------------------
+
+static bool PushJob(Job job)
+{
+    JobDeque *deque = &deques[threadIndex];
+    LockDeque(deque);
+    int bottom = deque->bottom;
+    bool full = (bottom - deque->top == JOB_QUEUE_SIZE);
+    if (!full)
+    {
+        deque->jobs[bottom & (JOB_QUEUE_SIZE - 1)] = job;
+        AtomicStore(&deque->bottom, bottom + 1);
+    }
+    UnlockDeque(deque);
+
+    return !full;
+}
+
+// The newest of this thread's jobs, or else the oldest job of another thread
+static bool FindJob(Job *job)
+{
+    JobDeque *own = &deques[threadIndex];
+    LockDeque(own);
+    int bottom = own->bottom;
+    bool found = (bottom != own->top);
+    if (found)
+    {
+        *job = own->jobs[(bottom - 1) & (JOB_QUEUE_SIZE - 1)];
+        AtomicStore(&own->bottom, bottom - 1);
+    }
+    UnlockDeque(own);
+    if (found) return true;
+
+    // The outside thread's deque is looked at after the workers', only by
+    // them, a long job from it would stall the main thread's frame
+    int threads = AtomicLoad(&workerCount) + 1;
+    int position = (threadIndex == JOB_OUTSIDE_DEQUE)? threads : threadIndex;
+    for (int i = 1; i <= threads; i++)
+    {
+        int index = (position + i)%(threads + 1);
+        if (index == threads)
+        {
+            if (threadIndex == 0) continue;
+            index = JOB_OUTSIDE_DEQUE;
+        }
+        JobDeque *victim = &deques[index];
+        if (AtomicLoad(&victim->bottom) == AtomicLoad(&victim->top)) continue; // Rechecked under the lock
+
+        LockDeque(victim);
+        int top = victim->top;
+        found = (victim->bottom != top);
+        if (found)
+        {
+            *job = victim->jobs[top & (JOB_QUEUE_SIZE - 1)];
+            AtomicStore(&victim->top, top + 1);
+        }
+        UnlockDeque(victim);
+        if (found) return true;
+    }
+
+    return false;
+}
+
+static void RunJobNow(Job *job)
+{
+    if (job->func != NULL) job->func(job->data);
+    else job->rangeFunc(job->data, job->start, job->end);
+
+    if (job->counter != NULL) AtomicAdd(&job->counter->pending, -1); // Publishes the job's writes
+}
+
+static void LockDeque(JobDeque *deque)
+{
+    while (!AtomicCompareExchange(&deque->lock, 0, 1))
+        YieldThread();
+}
+
+static void UnlockDeque(JobDeque *deque)
+{
+    AtomicStore(&deque->lock, 0);
+}
@@ -0,0 +1,286 @@
+// EXPLANATION:
+// Loads assets in the background while the logo animation plays
+// See loader.h for more documentation/descriptions
+
+#include "loader.h"
+#include "archive.h"
+#include "profiler.h"
+#include "threads.h"
+#include "jobs.h"
+#include "fracture.h"
+
+#include <stddef.h> // NULL
+
+#define FONT_GLYPH_COUNT 95  // Same defaults as LoadFontEx()
+#define FONT_GLYPH_PADDING 4
+
+typedef enum { ASSET_FONT, ASSET_SOUND, ASSET_WAVE, ASSET_MUSIC, ASSET_ATLAS, ASSET_FRACTURE } AssetType;
+typedef enum { TASK_QUEUED, TASK_DECODED, TASK_DONE } TaskState;
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef struct LoadTask {
+    AssetType type;
+    const char *fileName;
+    const char **fileNames; // Atlas sprites
+    int size;               // Font size, atlas sprite count, or fracture piece count
+    int fontType;           // FONT_DEFAULT or FONT_SDF
+    void *destination;
+    volatile int state;     // TaskState, set to TASK_DECODED by whoever decodes
+
+    // Decoded on the loader thread, finished on the main thread
+    Image image;
+    Wave wave;
+    Font font;
+    Rectangle regions[ATLAS_MAX_SPRITES];
+} LoadTask;
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static LoadTask *QueueTask(AssetType type, void *destination, const char *fileName);
+static int RunLoaderThread(void *arg);
+static void DecodeTasks(void *data, int start, int end);
+static void DecodeTask(LoadTask *task);
+static void FinishTask(LoadTask *task);
+static void FreeDecodedTask(LoadTask *task);
+
+// Loader state
+static LoadTask tasks[LOADER_MAX_ASSETS];
+static int taskCount = 0;
+static int finishedCount = 0; // Tasks are finished in queue order
+static int decodedCount = 0;  // Only used without a loader thread
+static Thread loaderThread = { 0 };
+static volatile int cancelled = 0;
+
+// Queueing
+// ----------------------------------------------------------------------------
+
+void QueueFontLoad(Font *font, const char *fileName, int fontSize, int fontType)
+{
+    LoadTask *task = QueueTask(ASSET_FONT, font, fileName);
+    if (task == NULL) return;
+
+    task->size = fontSize;
+    task->fontType = fontType;
+}
+
+void QueueSoundLoad(Sound *sound, const char *fileName)
+{
+    QueueTask(ASSET_SOUND, sound, fileName);
+}
+
+void QueueWaveLoad(Wave *wave, const char *fileName)
+{
+    QueueTask(ASSET_WAVE, wave, fileName);
+}
+
+void QueueMusicLoad(Music *music, const char *fileName)
+{
+    QueueTask(ASSET_MUSIC, music, fileName);
+}
+
+void QueueAtlasLoad(SpriteAtlas *atlas, const char **fileNames, int count)
+{
+    LoadTask *task = QueueTask(ASSET_ATLAS, atlas, "atlas");
+    if (task == NULL) return;
+
+    task->fileNames = fileNames;
+    task->size = (count > ATLAS_MAX_SPRITES)? ATLAS_MAX_SPRITES : count;
+}
+
+void QueueFractureLoad(FracturePattern *pattern, const char *fileName, int pieceCount)
+{
+    LoadTask *task = QueueTask(ASSET_FRACTURE, pattern, fileName);
+    if (task == NULL) return;
+
+    task->size = pieceCount;
+}
+
+static LoadTask *QueueTask(AssetType type, void *destination, const char *fileName)
+{
+    if (taskCount >= LOADER_MAX_ASSETS)
+    {
+        TraceLog(LOG_WARNING, "LOADER: [%s] Too many assets, max is %i", fileName, LOADER_MAX_ASSETS);
+        return NULL;
+    }
+
+    LoadTask *task = &tasks[taskCount++];
+    *task = (LoadTask){ .type = type, .fileName = fileName, .destination = destination, .state = TASK_QUEUED };
+    return task;
+}
+
+// Loading
+// ----------------------------------------------------------------------------
+
+void StartAssetLoading(void)
+{
+    AtomicStore(&cancelled, 0);
+    if (StartThread(&loaderThread, RunLoaderThread, NULL))
+        TraceLog(LOG_INFO, "LOADER: Loading %i assets on a loader thread", taskCount);
+    else
+        TraceLog(LOG_INFO, "LOADER: Loading %i assets between frames", taskCount);
+}
+
+bool UpdateAssetLoading(void)
+{
+    if (finishedCount == taskCount) return true;
+
+    // Without a loader thread, decode here until the frame's budget is spent
+    double start = GetProfilerTime();
+    if (!loaderThread.started)
+    {
+        while ((decodedCount < taskCount) && (GetProfilerTime() - start < LOADER_DECODE_BUDGET))
+            DecodeTask(&tasks[decodedCount++]);
+
+        start = GetProfilerTime();
+    }
+
+    // Finish decoded assets on the main thread, at least one per frame
+    while ((finishedCount < taskCount) && (AtomicLoad(&tasks[finishedCount].state) == TASK_DECODED))
+    {
+        FinishTask(&tasks[finishedCount++]);
+        if (GetProfilerTime() - start >= LOADER_UPLOAD_BUDGET) break;
+    }
+
+    if (finishedCount < taskCount) return false;
+
+    JoinThread(&loaderThread);
+    TraceLog(LOG_INFO, "LOADER: Loaded %i assets", taskCount);
+    return true;
+}
+
+void StopAssetLoading(void)
+{
+    AtomicStore(&cancelled, 1);
+    JoinThread(&loaderThread);
+
+    for (int i = finishedCount; i < taskCount; i++)
+    {
+        if (AtomicLoad(&tasks[i].state) == TASK_DECODED)
+            FreeDecodedTask(&tasks[i]);
+    }
+
+    taskCount = 0;
+    finishedCount = 0;
+    decodedCount = 0;
+}
+
+static int RunLoaderThread(void *arg)
+{
+    (void)arg;
+    InitJobThread();
+
+    // Assets don't depend on each other, idle job workers decode them side by side
+    ParallelFor(taskCount, 1, DecodeTasks, NULL);
+    return 0;
+}
+
+static void DecodeTasks(void *data, int start, int end)
+{
+    (void)data;
+    for (int i = start; (i < end) && !AtomicLoad(&cancelled); i++)
+        DecodeTask(&tasks[i]);
+}
+
+// Everything that doesn't need the GPU or the audio device, safe on any thread
+static void DecodeTask(LoadTask *task)
+{
+    switch (task->type)
+    {
+        case ASSET_FONT:
+        {
+            int dataSize = 0;
+            const unsigned char *data = GetAssetData(task->fileName, &dataSize);
+            unsigned char *fileData = NULL;
+            if (data == NULL) data = fileData = LoadFileData(task->fileName, &dataSize);
+
+            Font font = { .baseSize = task->size, .glyphCount = FONT_GLYPH_COUNT };
+            font.glyphs = (data != NULL)? LoadFontData(data, dataSize, font.baseSize, NULL, font.glyphCount, task->fontType) : NULL;
+            if (font.glyphs != NULL)
+            {
+                // SDF glyphs come with their own padding, where the distance fades out
+                font.glyphPadding = (task->fontType == FONT_SDF)? 0 : FONT_GLYPH_PADDING;
+                task->image = GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, font.baseSize, font.glyphPadding, 0);
+
+                // Glyph images are cut from the atlas, like LoadFontEx() does
+                for (int i = 0; i < font.glyphCount; i++)
+                {
+                    UnloadImage(font.glyphs[i].image);
+                    font.glyphs[i].image = ImageFromImage(task->image, font.recs[i]);
+                }
+            }
+            task->font = font;
+            UnloadFileData(fileData);
+        } break;
+
+        case ASSET_SOUND:
+        case ASSET_WAVE: task->wave = LoadAssetWave(task->fileName); break;
+        case ASSET_MUSIC: break; // Nothing to decode up front, it streams
+        case ASSET_ATLAS: task->image = LoadAtlasImage(task->fileNames, task->size, task->regions); break;
+
+        // Plain data, written straight to its destination, nothing reads it until loading is done
+        case ASSET_FRACTURE: *(FracturePattern *)task->destination = LoadFracturePattern(task->fileName, task->size); break;
+    }
+
+    AtomicStore(&task->state, TASK_DECODED);
+}
+
+// GPU uploads and audio device work, main thread only
+static void FinishTask(LoadTask *task)
+{
+    switch (task->type)
+    {
+        case ASSET_FONT:
+            if (task->font.glyphs != NULL)
+            {
+                task->font.texture = LoadTextureFromImage(task->image);
+                UnloadImage(task->image);
+                *(Font *)task->destination = task->font;
+            }
+            else *(Font *)task->destination = GetFontDefault();
+            break;
+
+        case ASSET_SOUND:
+            *(Sound *)task->destination = LoadSoundFromWave(task->wave);
+            UnloadWave(task->wave);
+            break;
+
+        case ASSET_WAVE:
+            *(Wave *)task->destination = task->wave;
+            break;
+
+        case ASSET_MUSIC:
+            *(Music *)task->destination = LoadAssetMusicStream(task->fileName);
+            break;
+
+        case ASSET_ATLAS:
+            *(SpriteAtlas *)task->destination = LoadSpriteAtlasFromImage(task->image, task->regions, task->size);
+            UnloadImage(task->image);
+            break;
+
+        case ASSET_FRACTURE: break; // Already in place
+    }
+
+    AtomicStore(&task->state, TASK_DONE);
+}
+
+static void FreeDecodedTask(LoadTask *task)
+{
+    switch (task->type)
+    {
+        case ASSET_FONT:
+            if (task->font.glyphs != NULL)
+            {
+                UnloadImage(task->image);
+                UnloadFontData(task->font.glyphs, task->font.glyphCount);
+                MemFree(task->font.recs);
+            }
+            break;
+
+        case ASSET_SOUND:
+        case ASSET_WAVE: UnloadWave(task->wave); break;
+        case ASSET_MUSIC: break;
+        case ASSET_ATLAS: UnloadImage(task->image); break;
+        case ASSET_FRACTURE: break;
+    }
+}
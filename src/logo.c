@@ -5,6 +5,8 @@
 #include "logo.h"
 #include "config.h"
 #include "game.h"
+#include "input.h"
+#include "allocator.h"
 
 // Global animation state
 LogoAnimation logo = { 0 };
@@ -38,10 +40,7 @@ void UpdateRaylibLogo(void)
     const float epsilon = 0.0001f;
 
     // Press key or click or touch to skip
-    if ((!IsKeyDown(KEY_LEFT_ALT) && !IsKeyDown(KEY_RIGHT_ALT) &&
-         !IsKeyDown(KEY_LEFT_SHIFT) && !IsKeyDown(KEY_RIGHT_SHIFT) &&
-         !IsKeyDown(KEY_LEFT_CONTROL) && !IsKeyDown(KEY_RIGHT_CONTROL)) &&
-        ((GetKeyPressed() != KEY_NULL) || IsGestureDetected(GESTURE_TAP)))
+    if (input.skipPressed)
     {
         if ((logo.lettersCount < 6) && (logo.alpha < epsilon))
         {
@@ -134,8 +133,8 @@ void UpdateRaylibLogo(void)
                 logo.state = LOGO_END;
             break;
 
-        case LOGO_END: // Animation is finished
-            currentScreen++;
+        case LOGO_END: // Animation is finished, wait for the game to load if needed
+            if (gameLoaded) currentScreen++;
             break;
     }
 }
@@ -190,7 +189,7 @@ void DrawRaylibLogo(void)
             DrawRectangle(rectPosX + offsetA, rectPosY + lineWidth, lineWidth, rightHeight - offsetB, RAYLIB_LOGO_COLOR);
             DrawRectangle(rectPosX, rectPosY + offsetA, bottomWidth, lineWidth, RAYLIB_LOGO_COLOR);
 
-            DrawText(TextSubtext("raylib", 0, logo.lettersCount),
+            DrawText(ArenaFormat(&frameArena, "%.*s", logo.lettersCount, "raylib"),
                      VIRTUAL_WIDTH/2 - offsetC, VIRTUAL_HEIGHT/2 + offsetD,
                      fontSize, RAYLIB_LOGO_COLOR);
 
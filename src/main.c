@@ -4,10 +4,17 @@
 
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
 
 #include "config.h" // Program config, e.g. window title/size, fps, vsync
 #include "logo.h"  // Raylib logo animation
 #include "game.h"
+#include "input.h" // Input latched per rendered frame
+#include "profiler.h" // Frame timings, F3 shows them
+#include "allocator.h" // Frame arena, reset every frame
+#include "jobs.h" // Pipelined simulation runs as a job
+
+#include <time.h> // time, seeds input recordings
 
 #if defined(PLATFORM_WEB) // for compiling to wasm (web assembly)
     #include <emscripten/emscripten.h>
@@ -17,13 +24,43 @@ typedef struct Viewport {
     int width, height, x, y;
 } Viewport;
 
+// One frame's simulation steps, run right away or, pipelined, on a job
+// worker while the main thread draws what the previous batch left
+typedef struct SimulationBatch {
+    int steps;
+    double stepTimes[MAX_SIMULATION_STEPS];       // See stepTime
+    Vector2 mousePositions[MAX_SIMULATION_STEPS]; // Sampled up front, the mouse path changes while the frame draws
+    float alpha;                                  // See renderAlpha
+    GameRenderState *renderState;                 // Captured after the steps
+    float updateTime;                             // Milliseconds the steps took
+    bool frameThread;                             // Ran where the zones count (WaitForJobs() helps), nothing to add
+    bool replayOver;
+} SimulationBatch;
+
 // Globals
 // ----------------------------------------------------------------------------
 Viewport view;  // for rendering within aspect ratio
 Camera2D camera;
 ScreenState currentScreen;
 float frameTime;
+float renderAlpha;
+double stepTime;
 bool gameShouldExit;
+bool showDebugStats;
+
+// Pipelined simulation (see PIPELINED_SIMULATION in config.h)
+bool pipelinedSimulation = PIPELINED_SIMULATION;
+GameRenderState renderStates[2]; // Double buffered, a batch captures one while the other is drawn
+int renderStateIndex;            // The one the last batch captured
+SimulationBatch simulationBatch;
+JobCounter simulationJob;
+bool simulationRunning;          // A pipelined batch was started and not waited for
+
+// Internal resolution (see RENDER_TO_TEXTURE in config.h)
+RenderTexture2D renderTarget; // Sized for RENDER_SCALE_MAX, smaller scales use its top left corner
+Rectangle renderRect;         // Part of the render target drawn this frame
+float renderScale = RENDER_SCALE_MAX;
+Camera2D screenCamera;        // The window's camera while the game draws to the render target
 
 // Local Functions Declaration
 // ----------------------------------------------------------------------------
@@ -32,20 +69,44 @@ void RunGameLoop(void);     // Runs the game loop depending on platform
 
 void UpdateDrawFrame(void); // Update and Draw the current frame
                             // Most of the game loop's code is found in here
+void RunSimulationBatch(void *data); // A SimulationBatch's steps, on any thread
 
 void UpdateCameraViewport(void);
 void HandleToggleFullscreen(void);
+void UpdateRenderScale(void); // Dynamic resolution, adjusts renderScale to the frame times
+void BeginGameDraw(void);     // Starts the frame, game drawing goes to the render target when there is one
+void EndGameDraw(void);       // Scales the render target up into the viewport, window drawing follows
 
 // Main entry point
 // ----------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     // ----------------------------------------------------------------------------
     CreateNewWindow();
+    InitInputSampling();
     InitAudioDevice();
     InitRaylibLogo();
     InitGameState();
+    frameTime = 1.0f/SIMULATION_RATE; // Fixed, set before any step can read it on a worker
+
+    // Input recording: --record <file> or --replay <file>
+    // Arcade pinata wall: --wall <count>
+    // Pipelined simulation: --pipelined
+    const char *recordFile = NULL;
+    const char *replayFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (TextIsEqual(argv[i], "--pipelined")) pipelinedSimulation = true;
+        else if (hasValue && TextIsEqual(argv[i], "--record")) recordFile = argv[i + 1];
+        else if (hasValue && TextIsEqual(argv[i], "--replay")) replayFile = argv[i + 1];
+        else if (hasValue && TextIsEqual(argv[i], "--wall")) pinataWallSize = TextToInteger(argv[i + 1]);
+    }
+
+    // After the wall size is known, a recording keeps it and a replay brings its own
+    if (replayFile != NULL) StartInputReplay(replayFile, &pinataWallSize);
+    else if (recordFile != NULL) StartInputRecording(recordFile, (unsigned int)time(NULL), pinataWallSize);
 
     // Start the game loop
     // (See UpdateDrawFrame() for the full game loop)
@@ -53,7 +114,10 @@ int main(void)
 
     // De-Initialization
     // ----------------------------------------------------------------------------
+    WaitForJobs(&simulationJob); // A pipelined batch may still be running
+    StopInputCapture();
     FreeGameState();
+    if (RENDER_TO_TEXTURE) UnloadRenderTexture(renderTarget);
     CloseAudioDevice();
     CloseWindow(); // Close window and OpenGL context
 
@@ -62,7 +126,9 @@ int main(void)
 
 void CreateNewWindow(void)
 {
-    unsigned int windowFlags = FLAG_MSAA_4X_HINT;
+    // The render target has no MSAA, and the window then only gets the upscaled
+    // texture, so the window's MSAA would cost fill rate for nothing
+    unsigned int windowFlags = RENDER_TO_TEXTURE? 0 : FLAG_MSAA_4X_HINT;
 #if !defined(PLATFORM_WEB) // no resize or vsync for web, emscripten handles that
     windowFlags |= FLAG_WINDOW_RESIZABLE;
     if (VSYNC_ENABLED) windowFlags |= FLAG_VSYNC_HINT;
@@ -70,6 +136,12 @@ void CreateNewWindow(void)
     SetConfigFlags(windowFlags);
     InitWindow(INITIAL_WIDTH, INITIAL_HEIGHT, WINDOW_TITLE);
     SetWindowMinSize(320, 240);
+
+    if (RENDER_TO_TEXTURE)
+    {
+        renderTarget = LoadRenderTexture((int)(VIRTUAL_WIDTH*RENDER_SCALE_MAX), (int)(VIRTUAL_HEIGHT*RENDER_SCALE_MAX));
+        SetTextureFilter(renderTarget.texture, TEXTURE_FILTER_BILINEAR);
+    }
 }
 
 void RunGameLoop(void)
@@ -94,45 +166,159 @@ void UpdateDrawFrame(void)
     // Update
     // ----------------------------------------------------------------------------
 
+    PROFILE_FRAME_BEGIN();
+
+    // A pipelined batch reads input and writes game state, it's done before either is touched
+    SimulationBatch *batch = &simulationBatch;
+    if (simulationRunning)
+    {
+        PROFILE_BEGIN(ZONE_WAIT);
+        WaitForJobs(&simulationJob);
+        simulationRunning = false;
+        PROFILE_END(ZONE_WAIT);
+        if (!batch->frameThread) PROFILE_ADD(ZONE_UPDATE, batch->updateTime);
+        if (batch->replayOver) gameShouldExit = true;
+    }
+
+    ResetArena(&frameArena); // Last frame's scratch is done with
+
     // Global updates
-    frameTime = GetFrameTime();
     HandleToggleFullscreen();
     UpdateCameraViewport();
+    PollGameInput();
+    if (IsKeyPressed(KEY_F3))
+        showDebugStats = !showDebugStats;
+
+    // Assets load behind the logo, gameplay waits until they're done
+    if (!gameLoaded)
+    {
+        PROFILE_BEGIN(ZONE_LOAD);
+        UpdateGameLoading();
+        PROFILE_END(ZONE_LOAD);
+    }
 
-    switch(currentScreen)
+    // Fixed-step simulation
+    // Run as many steps as real time has passed, and carry the remainder over
+    static float accumulator = 0.0f;
+    const float timestep = 1.0f/SIMULATION_RATE;
+    accumulator += GetFrameTime();
+    if (accumulator > MAX_SIMULATION_STEPS*timestep)
+        accumulator = MAX_SIMULATION_STEPS*timestep;
+
+    double now = GetProfilerTime();
+    batch->steps = 0;
+    while ((accumulator >= timestep) && (batch->steps < MAX_SIMULATION_STEPS))
+    {
+        // Mouse where it was at this step's time, the last step gets the newest sample
+        SampleMousePath(accumulator - timestep);
+        batch->mousePositions[batch->steps] = input.mousePosition;
+        batch->stepTimes[batch->steps] = now - (accumulator - timestep);
+        batch->steps++;
+        accumulator -= timestep;
+    }
+
+    // How far between the last two simulation steps to draw
+    renderAlpha = accumulator/timestep;
+    batch->alpha = renderAlpha;
+    batch->replayOver = false;
+
+    // Pipelined, this frame's steps run on a worker and the last batch's state
+    // is drawn meanwhile, else the steps run here and their state is drawn
+    GameRenderState *drawState = &renderStates[renderStateIndex];
+    if (pipelinedSimulation && (currentScreen == SCREEN_GAMEPLAY) && (GetJobWorkerCount() > 0))
     {
-        case SCREEN_LOGO:     UpdateRaylibLogo();
-                              break;
-        case SCREEN_GAMEPLAY: UpdateGameFrame();
-                              break;
-        default: break;
+        renderStateIndex ^= 1;
+        batch->renderState = &renderStates[renderStateIndex];
+        RunJob(RunSimulationBatch, batch, &simulationJob);
+        simulationRunning = true;
+    }
+    else
+    {
+        batch->renderState = drawState;
+        RunSimulationBatch(batch);
+        if (batch->replayOver) gameShouldExit = true;
     }
 
     // Draw
     // ----------------------------------------------------------------------------
-    BeginDrawing();
-    ClearBackground(BLACK);
+    if (RENDER_TO_TEXTURE && DYNAMIC_RESOLUTION && gameLoaded)
+        UpdateRenderScale();
 
-        BeginScissorMode(view.x, view.y, // Draw within aspect ratio
-                         view.width, view.height);
-            BeginMode2D(camera);    // Scale to camera view
+    BeginGameDraw(); // Within the viewport, or to the render target
+    ResetDrawStats();
 
-            switch(currentScreen)
-            {
-                case SCREEN_LOGO:     DrawRaylibLogo();
-                                      break;
-                case SCREEN_GAMEPLAY: DrawGameFrame();
-                                      break;
-                default: break;
-            }
+        BeginMode2D(camera);    // Scale to camera view
 
-            EndMode2D();
-        EndScissorMode();
+        switch(currentScreen)
+        {
+            case SCREEN_LOGO:     DrawRaylibLogo();
+                                  break;
+            case SCREEN_GAMEPLAY: PROFILE_BEGIN(ZONE_DRAW);
+                                  DrawGameFrame(drawState);
+                                  PROFILE_END(ZONE_DRAW);
+                                  break;
+            default: break;
+        }
+
+        EndMode2D();
+
+    EndGameDraw();
 
-    // Debug:
-    // DrawFPS(0, 0);
+    // Debug: F3 shows framerate, how many batches the game drew with and zone timings
+    if (showDebugStats)
+    {
+        DrawFPS(0, 0);
+        DrawText(ArenaFormat(&frameArena, "%i batches", GetDrawBatchCount()), 0, 20, 20, LIME);
+        if (RENDER_TO_TEXTURE)
+            DrawText(ArenaFormat(&frameArena, "%ix%i render (%i%%)", (int)renderRect.width, (int)renderRect.height,
+                                (int)(renderScale*100.0f + 0.5f)), 0, 44, 20, LIME);
+        DrawProfilerOverlay(0, RENDER_TO_TEXTURE? 68 : 44);
+    }
 
+    PROFILE_BEGIN(ZONE_SWAP);
     EndDrawing();
+    PROFILE_END(ZONE_SWAP);
+
+    PROFILE_FRAME_END();
+}
+
+void RunSimulationBatch(void *data)
+{
+    SimulationBatch *batch = data;
+    double start = GetProfilerTime();
+    batch->frameThread = IsProfilerFrameThread();
+
+    for (int i = 0; i < batch->steps; i++)
+    {
+        input.mousePosition = batch->mousePositions[i];
+        stepTime = batch->stepTimes[i];
+        if ((currentScreen == SCREEN_GAMEPLAY) && !BeginInputStep())
+        {
+            batch->replayOver = true; // No input left to step with, the game exits
+            break;
+        }
+
+        switch(currentScreen)
+        {
+            case SCREEN_LOGO:     PROFILE_BEGIN(ZONE_LOGO);
+                                  UpdateRaylibLogo();
+                                  PROFILE_END(ZONE_LOGO);
+                                  break;
+            case SCREEN_GAMEPLAY: PROFILE_BEGIN(ZONE_UPDATE);
+                                  UpdateGameFrame();
+                                  PROFILE_END(ZONE_UPDATE);
+                                  break;
+            default: break;
+        }
+
+        ConsumeGameInput();
+    }
+
+    // The logo draws from its own state
+    if (currentScreen == SCREEN_GAMEPLAY)
+        CaptureRenderState(batch->renderState, batch->alpha);
+
+    batch->updateTime = (float)((GetProfilerTime() - start)*1000.0);
 }
 
 void UpdateCameraViewport(void)
@@ -179,3 +365,101 @@ void HandleToggleFullscreen(void)
     }
 #endif
 }
+
+void UpdateRenderScale(void)
+{
+    static float averageFrameTime = 0.0f;
+    static float cooldown = 0.0f;
+    static float keptPace = 0.0f;     // Seconds the frames have kept up with the target
+    static float raiseDelay = 1.0f;   // Seconds of keeping pace before trying a higher scale
+    static float sinceRaised = 100.0f;
+
+    // Frames can't come faster than the display refreshes (or the framerate cap)
+    int targetRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    if (targetRate <= 0) targetRate = 60; // Unknown, e.g. on web
+    if ((MAX_FRAMERATE > 0) && (MAX_FRAMERATE < targetRate)) targetRate = MAX_FRAMERATE;
+
+    float targetFrameTime = 1.0f/targetRate;
+    float delta = GetFrameTime();
+    averageFrameTime = (averageFrameTime > 0.0f)? Lerp(averageFrameTime, delta, 0.1f) : delta;
+    cooldown -= delta;
+    sinceRaised += delta;
+    if (cooldown > 0.0f) return;
+
+    if ((averageFrameTime > targetFrameTime*1.15f) && (renderScale > RENDER_SCALE_MIN))
+    {
+        // Falling behind, and a higher scale just failed: wait longer before the next try
+        if (sinceRaised < 2.0f) raiseDelay = fminf(raiseDelay*2.0f, 16.0f);
+        renderScale = fmaxf(renderScale - RENDER_SCALE_STEP, RENDER_SCALE_MIN);
+        cooldown = RENDER_SCALE_COOLDOWN;
+        keptPace = 0.0f;
+    }
+    else if (averageFrameTime < targetFrameTime*1.05f)
+    {
+        // Vsync hides how much headroom there is, so just try a step up
+        keptPace += delta;
+        if ((keptPace > raiseDelay) && (renderScale < RENDER_SCALE_MAX))
+        {
+            renderScale = fminf(renderScale + RENDER_SCALE_STEP, RENDER_SCALE_MAX);
+            cooldown = RENDER_SCALE_COOLDOWN;
+            keptPace = 0.0f;
+            sinceRaised = 0.0f;
+        }
+    }
+    else keptPace = 0.0f;
+}
+
+void BeginGameDraw(void)
+{
+    if (!RENDER_TO_TEXTURE)
+    {
+        BeginDrawing();
+        ClearBackground(BLACK);
+        BeginScissorMode(view.x, view.y, view.width, view.height); // Draw within aspect ratio
+        return;
+    }
+
+    // Internal resolution, no bigger than the viewport itself
+    int height = (int)(VIRTUAL_HEIGHT*renderScale);
+    if (height > view.height) height = view.height;
+    if (height > renderTarget.texture.height) height = renderTarget.texture.height;
+    int width = (int)(height*ASPECT_RATIO);
+    if (width > renderTarget.texture.width) width = renderTarget.texture.width;
+    renderRect = (Rectangle){ 0, 0, (float)width, (float)height };
+
+    BeginTextureMode(renderTarget);
+    ClearBackground(BLACK);
+
+    // Draw into the corner of the target that's in use
+    rlViewport(0, 0, width, height);
+    rlMatrixMode(RL_PROJECTION);
+    rlLoadIdentity();
+    rlOrtho(0, width, height, 0, 0.0, 1.0);
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+
+    // The camera maps the world onto the target, the window camera stays for input
+    screenCamera = camera;
+    camera.offset = (Vector2){ width/2.0f, height/2.0f };
+    camera.zoom = (float)width/VIRTUAL_WIDTH;
+}
+
+void EndGameDraw(void)
+{
+    if (!RENDER_TO_TEXTURE)
+    {
+        EndScissorMode();
+        return;
+    }
+
+    EndTextureMode();
+    camera = screenCamera;
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    // Render textures are upside down, a negative height flips them
+    Rectangle source = { renderRect.x, renderRect.y, renderRect.width, -renderRect.height };
+    Rectangle destination = { (float)view.x, (float)view.y, (float)view.width, (float)view.height };
+    DrawTexturePro(renderTarget.texture, source, destination, (Vector2){ 0 }, 0.0f, WHITE);
+}
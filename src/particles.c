@@ -0,0 +1,431 @@
+// EXPLANATION:
+// Particle storage and simulation, used for the candy bursts and pinata pieces
+// See particles.h for more documentation/descriptions
+
+#include "particles.h"
+#include "allocator.h"
+#include "jobs.h"
+
+#include <stdint.h> // uintptr_t
+
+#if defined(_MSC_VER) // MSVC only knows restrict in C11 mode
+    #define restrict __restrict
+#endif
+
+// Every kernel does a separate multiply and add, so the scalar kernel must
+// not be contracted into fused multiply-adds or results would differ
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+    #pragma GCC optimize("fp-contract=off")
+#endif
+
+// Instruction sets this build can compile kernels for
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define PARTICLES_SSE2
+    #include <emmintrin.h>
+    #if defined(__GNUC__) || defined(_MSC_VER)
+        #define PARTICLES_AVX2
+        #include <immintrin.h>
+    #endif
+    #if defined(_MSC_VER)
+        #include <intrin.h> // __cpuidex, _xgetbv
+    #endif
+#endif
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+    #define PARTICLES_NEON
+    #include <arm_neon.h>
+#endif
+#if defined(__wasm_simd128__)
+    #define PARTICLES_WASM128
+    #include <wasm_simd128.h>
+#endif
+
+// Number of float arrays in a ParticleSystem (everything except source and textureId)
+#define PARTICLE_FLOAT_ARRAYS 9
+
+// Particles per job when updating on several threads, a multiple of
+// PARTICLE_BATCH that keeps every job's arrays aligned
+#define PARTICLE_JOB_SIZE 4096
+
+// Integrates particles [0, count), count is always a multiple of PARTICLE_BATCH
+typedef void (*ParticleKernelFunc)(ParticleSystem *particles, int count, float fall, float deltaTime);
+
+static void UpdateParticlesScalar(ParticleSystem *particles, int count, float fall, float deltaTime);
+#if defined(PARTICLES_SSE2)
+static void UpdateParticlesSSE2(ParticleSystem *particles, int count, float fall, float deltaTime);
+#endif
+#if defined(PARTICLES_AVX2)
+static void UpdateParticlesAVX2(ParticleSystem *particles, int count, float fall, float deltaTime);
+#endif
+#if defined(PARTICLES_NEON)
+static void UpdateParticlesNEON(ParticleSystem *particles, int count, float fall, float deltaTime);
+#endif
+#if defined(PARTICLES_WASM128)
+static void UpdateParticlesWASM128(ParticleSystem *particles, int count, float fall, float deltaTime);
+#endif
+
+static void UpdateParticleRange(void *data, int start, int end);
+static bool IsParticleKernelSupported(ParticleKernel kernel);
+static bool CpuSupportsAVX2(void);
+
+static const char *kernelNames[PARTICLE_KERNEL_COUNT] = { "scalar", "sse2", "avx2", "neon", "wasm128" };
+static ParticleKernel currentKernel = PARTICLE_KERNEL_COUNT; // picked on first init
+static ParticleKernelFunc kernelFunc = UpdateParticlesScalar;
+
+// What every job of one UpdateParticles() call shares
+typedef struct ParticleJob {
+    ParticleSystem *particles;
+    float fall;
+    float deltaTime;
+} ParticleJob;
+
+void InitParticles(ParticleSystem *particles, int capacity, Arena *arena)
+{
+    // Rounding up keeps every array a whole number of SIMD batches long,
+    // which also keeps the next array aligned
+    capacity = (capacity + PARTICLE_BATCH - 1)/PARTICLE_BATCH*PARTICLE_BATCH;
+    size_t floatBytes = (size_t)capacity*sizeof(float);
+    size_t totalBytes = PARTICLE_FLOAT_ARRAYS*floatBytes + (size_t)capacity*(sizeof(int) + 1) + PARTICLE_ALIGNMENT;
+
+    if (currentKernel == PARTICLE_KERNEL_COUNT)
+        SetParticleKernel(GetBestParticleKernel());
+
+    *particles = (ParticleSystem){ 0 };
+    particles->memory = (arena != NULL)? ArenaAlloc(arena, totalBytes) : GameAlloc(totalBytes); // zeroed
+    particles->ownsMemory = (arena == NULL);
+    if (particles->memory == NULL)
+    {
+        TraceLog(LOG_WARNING, "PARTICLES: Couldn't allocate %i particles", capacity);
+        return;
+    }
+    particles->capacity = capacity;
+
+    uintptr_t address = ((uintptr_t)particles->memory + PARTICLE_ALIGNMENT - 1) & ~(uintptr_t)(PARTICLE_ALIGNMENT - 1);
+    float *array = (float *)address;
+    particles->positionX     = array; array += capacity;
+    particles->positionY     = array; array += capacity;
+    particles->prevPositionX = array; array += capacity;
+    particles->prevPositionY = array; array += capacity;
+    particles->velocityX     = array; array += capacity;
+    particles->velocityY     = array; array += capacity;
+    particles->angle         = array; array += capacity;
+    particles->prevAngle     = array; array += capacity;
+    particles->rotationRate  = array; array += capacity;
+    particles->source        = (int *)array;
+    particles->textureId     = (unsigned char *)(particles->source + capacity);
+}
+
+void FreeParticles(ParticleSystem *particles)
+{
+    if (particles->ownsMemory) GameFree(particles->memory); // Arena memory goes with its arena
+    *particles = (ParticleSystem){ 0 };
+}
+
+void ClearParticles(ParticleSystem *particles)
+{
+    particles->count = 0;
+}
+
+int EmitParticle(ParticleSystem *particles, Vector2 position, Vector2 velocity, float rotationRate, int textureId)
+{
+    if (particles->count >= particles->capacity)
+        return -1;
+
+    int i = particles->count++;
+    particles->positionX[i]     = position.x;
+    particles->positionY[i]     = position.y;
+    particles->prevPositionX[i] = position.x;
+    particles->prevPositionY[i] = position.y;
+    particles->velocityX[i]     = velocity.x;
+    particles->velocityY[i]     = velocity.y;
+    particles->angle[i]         = 0.0f;
+    particles->prevAngle[i]     = 0.0f;
+    particles->rotationRate[i]  = rotationRate;
+    particles->source[i]        = 0;
+    particles->textureId[i]     = (unsigned char)textureId;
+    return i;
+}
+
+void UpdateParticles(ParticleSystem *particles, float gravity, float deltaTime)
+{
+    // Round up to whole batches so kernels need no remainder loop, the
+    // padding is allocated and anything past count is overwritten on emit
+    int count = (particles->count + PARTICLE_BATCH - 1)/PARTICLE_BATCH*PARTICLE_BATCH;
+
+    // Particles don't affect each other, so big bursts are split across threads
+    ParticleJob job = { particles, gravity*deltaTime, deltaTime };
+    ParallelFor(count, PARTICLE_JOB_SIZE, UpdateParticleRange, &job);
+}
+
+int RemoveParticlesBelow(ParticleSystem *particles, float bottom)
+{
+    int removed = 0;
+    for (int i = particles->count - 1; i >= 0; i--) // Backwards, what's swapped in was checked already
+    {
+        if ((particles->positionY[i] <= bottom) || (particles->velocityY[i] < 0.0f)) continue;
+
+        int last = --particles->count;
+        particles->positionX[i]     = particles->positionX[last];
+        particles->positionY[i]     = particles->positionY[last];
+        particles->prevPositionX[i] = particles->prevPositionX[last];
+        particles->prevPositionY[i] = particles->prevPositionY[last];
+        particles->velocityX[i]     = particles->velocityX[last];
+        particles->velocityY[i]     = particles->velocityY[last];
+        particles->angle[i]         = particles->angle[last];
+        particles->prevAngle[i]     = particles->prevAngle[last];
+        particles->rotationRate[i]  = particles->rotationRate[last];
+        particles->source[i]        = particles->source[last];
+        particles->textureId[i]     = particles->textureId[last];
+        removed++;
+    }
+
+    return removed;
+}
+
+// Runs the kernel on a view of the arrays that starts at particle start
+static void UpdateParticleRange(void *data, int start, int end)
+{
+    ParticleJob *job = data;
+    ParticleSystem view = *job->particles;
+    view.positionX     += start;
+    view.positionY     += start;
+    view.prevPositionX += start;
+    view.prevPositionY += start;
+    view.velocityX     += start;
+    view.velocityY     += start;
+    view.angle         += start;
+    view.prevAngle     += start;
+    view.rotationRate  += start;
+    view.source        += start;
+    view.textureId     += start;
+    view.count = end - start;
+
+    kernelFunc(&view, end - start, job->fall, job->deltaTime);
+}
+
+// Kernel selection
+// ----------------------------------------------------------------------------
+
+ParticleKernel GetBestParticleKernel(void)
+{
+    static const ParticleKernel fastestFirst[] = {
+        PARTICLE_KERNEL_AVX2, PARTICLE_KERNEL_SSE2,
+        PARTICLE_KERNEL_NEON, PARTICLE_KERNEL_WASM128,
+    };
+    for (unsigned int i = 0; i < sizeof(fastestFirst)/sizeof(fastestFirst[0]); i++)
+        if (IsParticleKernelSupported(fastestFirst[i]))
+            return fastestFirst[i];
+    return PARTICLE_KERNEL_SCALAR;
+}
+
+bool SetParticleKernel(ParticleKernel kernel)
+{
+    if (!IsParticleKernelSupported(kernel))
+        return false;
+
+    switch (kernel)
+    {
+#if defined(PARTICLES_SSE2)
+        case PARTICLE_KERNEL_SSE2:    kernelFunc = UpdateParticlesSSE2; break;
+#endif
+#if defined(PARTICLES_AVX2)
+        case PARTICLE_KERNEL_AVX2:    kernelFunc = UpdateParticlesAVX2; break;
+#endif
+#if defined(PARTICLES_NEON)
+        case PARTICLE_KERNEL_NEON:    kernelFunc = UpdateParticlesNEON; break;
+#endif
+#if defined(PARTICLES_WASM128)
+        case PARTICLE_KERNEL_WASM128: kernelFunc = UpdateParticlesWASM128; break;
+#endif
+        default:                      kernelFunc = UpdateParticlesScalar; break;
+    }
+    currentKernel = kernel;
+    TraceLog(LOG_INFO, "PARTICLES: Using %s integration kernel", kernelNames[kernel]);
+    return true;
+}
+
+ParticleKernel GetParticleKernel(void)
+{
+    return (currentKernel == PARTICLE_KERNEL_COUNT)? GetBestParticleKernel() : currentKernel;
+}
+
+const char *GetParticleKernelName(ParticleKernel kernel)
+{
+    return ((kernel >= 0) && (kernel < PARTICLE_KERNEL_COUNT))? kernelNames[kernel] : "unknown";
+}
+
+static bool IsParticleKernelSupported(ParticleKernel kernel)
+{
+    switch (kernel)
+    {
+        case PARTICLE_KERNEL_SCALAR:  return true;
+#if defined(PARTICLES_SSE2)
+        case PARTICLE_KERNEL_SSE2:    return true;
+#endif
+#if defined(PARTICLES_AVX2)
+        case PARTICLE_KERNEL_AVX2:    return CpuSupportsAVX2();
+#endif
+#if defined(PARTICLES_NEON)
+        case PARTICLE_KERNEL_NEON:    return true;
+#endif
+#if defined(PARTICLES_WASM128)
+        case PARTICLE_KERNEL_WASM128: return true;
+#endif
+        default:                      return false;
+    }
+}
+
+static bool CpuSupportsAVX2(void)
+{
+#if defined(PARTICLES_AVX2) && defined(_MSC_VER)
+    // AVX2 flag, plus the OS saving the wide registers on context switches
+    int info[4];
+    __cpuidex(info, 0, 0);
+    if (info[0] < 7) return false;
+    __cpuidex(info, 1, 0);
+    bool osSavesAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    return osSavesAVX && (info[1] & (1 << 5));
+#elif defined(PARTICLES_AVX2)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Integration kernels
+// ----------------------------------------------------------------------------
+// All kernels do the same operations in the same order:
+//   prevPosition = position; position += velocity*deltaTime; velocity.y += fall
+//   prevAngle = angle; angle += rotationRate*deltaTime
+
+static void UpdateParticlesScalar(ParticleSystem *particles, int count, float fall, float deltaTime)
+{
+    // Separate restrict pointers let the compiler vectorize each loop
+    float *restrict positionX     = particles->positionX;
+    float *restrict positionY     = particles->positionY;
+    float *restrict prevPositionX = particles->prevPositionX;
+    float *restrict prevPositionY = particles->prevPositionY;
+    float *restrict velocityX     = particles->velocityX;
+    float *restrict velocityY     = particles->velocityY;
+    float *restrict angle         = particles->angle;
+    float *restrict prevAngle     = particles->prevAngle;
+    float *restrict rotationRate  = particles->rotationRate;
+
+    for (int i = 0; i < count; i++)
+    {
+        prevPositionX[i] = positionX[i];
+        prevPositionY[i] = positionY[i];
+        positionX[i] += velocityX[i]*deltaTime;
+        positionY[i] += velocityY[i]*deltaTime;
+        velocityY[i] += fall;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        prevAngle[i] = angle[i];
+        angle[i] += rotationRate[i]*deltaTime;
+    }
+}
+
+#if defined(PARTICLES_SSE2)
+static void UpdateParticlesSSE2(ParticleSystem *particles, int count, float fall, float deltaTime)
+{
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 dv = _mm_set1_ps(fall);
+    for (int i = 0; i < count; i += 4)
+    {
+        __m128 x  = _mm_load_ps(particles->positionX + i);
+        __m128 y  = _mm_load_ps(particles->positionY + i);
+        __m128 vx = _mm_load_ps(particles->velocityX + i);
+        __m128 vy = _mm_load_ps(particles->velocityY + i);
+        __m128 a  = _mm_load_ps(particles->angle + i);
+        __m128 r  = _mm_load_ps(particles->rotationRate + i);
+        _mm_store_ps(particles->prevPositionX + i, x);
+        _mm_store_ps(particles->prevPositionY + i, y);
+        _mm_store_ps(particles->prevAngle + i, a);
+        _mm_store_ps(particles->positionX + i, _mm_add_ps(x, _mm_mul_ps(vx, dt)));
+        _mm_store_ps(particles->positionY + i, _mm_add_ps(y, _mm_mul_ps(vy, dt)));
+        _mm_store_ps(particles->velocityY + i, _mm_add_ps(vy, dv));
+        _mm_store_ps(particles->angle + i, _mm_add_ps(a, _mm_mul_ps(r, dt)));
+    }
+}
+#endif
+
+#if defined(PARTICLES_AVX2)
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+#endif
+static void UpdateParticlesAVX2(ParticleSystem *particles, int count, float fall, float deltaTime)
+{
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 dv = _mm256_set1_ps(fall);
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256 x  = _mm256_load_ps(particles->positionX + i);
+        __m256 y  = _mm256_load_ps(particles->positionY + i);
+        __m256 vx = _mm256_load_ps(particles->velocityX + i);
+        __m256 vy = _mm256_load_ps(particles->velocityY + i);
+        __m256 a  = _mm256_load_ps(particles->angle + i);
+        __m256 r  = _mm256_load_ps(particles->rotationRate + i);
+        _mm256_store_ps(particles->prevPositionX + i, x);
+        _mm256_store_ps(particles->prevPositionY + i, y);
+        _mm256_store_ps(particles->prevAngle + i, a);
+        _mm256_store_ps(particles->positionX + i, _mm256_add_ps(x, _mm256_mul_ps(vx, dt)));
+        _mm256_store_ps(particles->positionY + i, _mm256_add_ps(y, _mm256_mul_ps(vy, dt)));
+        _mm256_store_ps(particles->velocityY + i, _mm256_add_ps(vy, dv));
+        _mm256_store_ps(particles->angle + i, _mm256_add_ps(a, _mm256_mul_ps(r, dt)));
+    }
+}
+#endif
+
+#if defined(PARTICLES_NEON)
+static void UpdateParticlesNEON(ParticleSystem *particles, int count, float fall, float deltaTime)
+{
+    const float32x4_t dt = vdupq_n_f32(deltaTime);
+    const float32x4_t dv = vdupq_n_f32(fall);
+    for (int i = 0; i < count; i += 4)
+    {
+        float32x4_t x  = vld1q_f32(particles->positionX + i);
+        float32x4_t y  = vld1q_f32(particles->positionY + i);
+        float32x4_t vx = vld1q_f32(particles->velocityX + i);
+        float32x4_t vy = vld1q_f32(particles->velocityY + i);
+        float32x4_t a  = vld1q_f32(particles->angle + i);
+        float32x4_t r  = vld1q_f32(particles->rotationRate + i);
+        vst1q_f32(particles->prevPositionX + i, x);
+        vst1q_f32(particles->prevPositionY + i, y);
+        vst1q_f32(particles->prevAngle + i, a);
+        // vmulq + vaddq on purpose, vmlaq/vfmaq may fuse and round differently
+        vst1q_f32(particles->positionX + i, vaddq_f32(x, vmulq_f32(vx, dt)));
+        vst1q_f32(particles->positionY + i, vaddq_f32(y, vmulq_f32(vy, dt)));
+        vst1q_f32(particles->velocityY + i, vaddq_f32(vy, dv));
+        vst1q_f32(particles->angle + i, vaddq_f32(a, vmulq_f32(r, dt)));
+    }
+}
+#endif
+
+#if defined(PARTICLES_WASM128)
+static void UpdateParticlesWASM128(ParticleSystem *particles, int count, float fall, float deltaTime)
+{
+    const v128_t dt = wasm_f32x4_splat(deltaTime);
+    const v128_t dv = wasm_f32x4_splat(fall);
+    for (int i = 0; i < count; i += 4)
+    {
+        v128_t x  = wasm_v128_load(particles->positionX + i);
+        v128_t y  = wasm_v128_load(particles->positionY + i);
+        v128_t vx = wasm_v128_load(particles->velocityX + i);
+        v128_t vy = wasm_v128_load(particles->velocityY + i);
+        v128_t a  = wasm_v128_load(particles->angle + i);
+        v128_t r  = wasm_v128_load(particles->rotationRate + i);
+        wasm_v128_store(particles->prevPositionX + i, x);
+        wasm_v128_store(particles->prevPositionY + i, y);
+        wasm_v128_store(particles->prevAngle + i, a);
+        wasm_v128_store(particles->positionX + i, wasm_f32x4_add(x, wasm_f32x4_mul(vx, dt)));
+        wasm_v128_store(particles->positionY + i, wasm_f32x4_add(y, wasm_f32x4_mul(vy, dt)));
+        wasm_v128_store(particles->velocityY + i, wasm_f32x4_add(vy, dv));
+        wasm_v128_store(particles->angle + i, wasm_f32x4_add(a, wasm_f32x4_mul(r, dt)));
+    }
+}
+#endif
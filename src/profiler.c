@@ -0,0 +1,176 @@
+// EXPLANATION:
+// Lightweight frame profiler with named zones
+// See profiler.h for more documentation/descriptions
+
+#include "profiler.h"
+#include "allocator.h"
+#include "threads.h"
+#include "raylib.h"
+
+#include <stdlib.h> // qsort
+
+#if defined(PLATFORM_WEB)
+    #include <emscripten/emscripten.h>
+#elif defined(_WIN32)
+    // Declared by hand, windows.h clashes with raylib's names
+    __declspec(dllimport) int __stdcall QueryPerformanceCounter(long long *count);
+    __declspec(dllimport) int __stdcall QueryPerformanceFrequency(long long *frequency);
+#else
+    #include <time.h>
+#endif
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static int CompareFloats(const void *a, const void *b);
+static ProfileStats SummarizeHistory(float *values); // Sorts the values
+
+// Profiler state
+static const char *zoneNames[PROFILE_ZONE_COUNT] = { "frame", "logo", "load", "wait", "update", "music", "draw", "swap" };
+static double zoneStart[PROFILE_ZONE_COUNT];          // When the zone was last entered
+static float zoneTime[PROFILE_ZONE_COUNT];            // Milliseconds spent in the zone this frame
+static float history[PROFILER_HISTORY][PROFILE_ZONE_COUNT];
+static int historyIndex;                              // Where the next frame goes
+static int historyCount;                              // Frames recorded, up to PROFILER_HISTORY
+static unsigned long long frameAllocationStart;       // Allocation count when the frame began
+static float allocationHistory[PROFILER_HISTORY];     // Heap allocations per frame
+static THREAD_LOCAL bool frameThread;                 // Set on the thread that runs the frames
+
+void ProfilerBeginFrame(void)
+{
+    frameThread = true;
+    for (int i = 0; i < PROFILE_ZONE_COUNT; i++)
+        zoneTime[i] = 0.0f;
+    frameAllocationStart = GetAllocationCount();
+    ProfilerBeginZone(ZONE_FRAME);
+}
+
+void ProfilerEndFrame(void)
+{
+    ProfilerEndZone(ZONE_FRAME);
+    for (int i = 0; i < PROFILE_ZONE_COUNT; i++)
+        history[historyIndex][i] = zoneTime[i];
+    allocationHistory[historyIndex] = (float)(GetAllocationCount() - frameAllocationStart);
+
+    historyIndex = (historyIndex + 1)%PROFILER_HISTORY;
+    if (historyCount < PROFILER_HISTORY) historyCount++;
+}
+
+void ProfilerBeginZone(ProfileZone zone)
+{
+    if (!frameThread) return; // Another thread, see ProfilerAddZoneTime()
+    zoneStart[zone] = GetProfilerTime();
+}
+
+void ProfilerEndZone(ProfileZone zone)
+{
+    // Zones can run several times per frame (once per simulation step)
+    if (!frameThread) return;
+    zoneTime[zone] += (float)((GetProfilerTime() - zoneStart[zone])*1000.0);
+}
+
+void ProfilerAddZoneTime(ProfileZone zone, float milliseconds)
+{
+    zoneTime[zone] += milliseconds;
+}
+
+bool IsProfilerFrameThread(void)
+{
+    return frameThread;
+}
+
+ProfileStats GetProfileStats(ProfileZone zone)
+{
+    float values[PROFILER_HISTORY];
+    for (int i = 0; i < historyCount; i++)
+        values[i] = history[i][zone];
+    return SummarizeHistory(values);
+}
+
+ProfileStats GetFrameAllocationStats(void)
+{
+    float values[PROFILER_HISTORY];
+    for (int i = 0; i < historyCount; i++)
+        values[i] = allocationHistory[i];
+    return SummarizeHistory(values);
+}
+
+static ProfileStats SummarizeHistory(float *values)
+{
+    ProfileStats stats = { 0 };
+    if (historyCount == 0) return stats;
+
+    float total = 0.0f;
+    for (int i = 0; i < historyCount; i++)
+        total += values[i];
+    qsort(values, historyCount, sizeof(float), CompareFloats);
+
+    int p99Index = (historyCount*99 + 99)/100 - 1; // ceil(0.99*n) - 1
+    stats.min = values[0];
+    stats.avg = total/historyCount;
+    stats.p99 = values[p99Index];
+    return stats;
+}
+
+double GetProfilerTime(void)
+{
+#if defined(PLATFORM_WEB)
+    return emscripten_get_now()/1000.0;
+#elif defined(_WIN32)
+    static long long frequency = 0;
+    if (frequency == 0) QueryPerformanceFrequency(&frequency);
+    long long count;
+    QueryPerformanceCounter(&count);
+    return (double)count/(double)frequency;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec*1e-9;
+#endif
+}
+
+void DrawProfilerOverlay(int x, int y)
+{
+#if PROFILER_ENABLED
+    const int fontSize = 20;
+    const int lineHeight = fontSize + 2;
+    const int columnWidth = 70; // default font isn't monospace, so columns are placed by hand
+    const int width = 80 + 3*columnWidth;
+    int height = lineHeight*(PROFILE_ZONE_COUNT + 2) + 8;
+
+    DrawRectangle(x, y, width, height, Fade(BLACK, 0.7f));
+    x += 4;
+    y += 4;
+    DrawText("ms", x, y, fontSize, LIME);
+    DrawText("min", x + 80, y, fontSize, LIME);
+    DrawText("avg", x + 80 + columnWidth, y, fontSize, LIME);
+    DrawText("p99", x + 80 + 2*columnWidth, y, fontSize, LIME);
+    for (int i = 0; i < PROFILE_ZONE_COUNT; i++)
+    {
+        y += lineHeight;
+        ProfileStats stats = GetProfileStats(i);
+        DrawText(zoneNames[i], x, y, fontSize, LIME);
+        DrawText(TextFormat("%.2f", stats.min), x + 80, y, fontSize, RAYWHITE);
+        DrawText(TextFormat("%.2f", stats.avg), x + 80 + columnWidth, y, fontSize, RAYWHITE);
+        DrawText(TextFormat("%.2f", stats.p99), x + 80 + 2*columnWidth, y, fontSize, RAYWHITE);
+    }
+
+    // Heap allocations per frame, should stay at 0 once the game is running
+    y += lineHeight;
+    ProfileStats allocations = GetFrameAllocationStats();
+    Color color = (allocations.p99 > 0.0f)? ORANGE : RAYWHITE;
+    DrawText("allocs", x, y, fontSize, LIME);
+    DrawText(TextFormat("%.0f", allocations.min), x + 80, y, fontSize, color);
+    DrawText(TextFormat("%.1f", allocations.avg), x + 80 + columnWidth, y, fontSize, color);
+    DrawText(TextFormat("%.0f", allocations.p99), x + 80 + 2*columnWidth, y, fontSize, color);
+#else
+    (void)x;
+    (void)y;
+#endif
+}
+
+static int CompareFloats(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
@@ -0,0 +1,149 @@
+// EXPLANATION:
+// Verlet rope physics, the strings the pinatas hang from
+// See rope.h for more documentation/descriptions
+
+#include "rope.h"
+#include "jobs.h"
+#include "raymath.h"
+
+// Ropes per job when updating on several threads
+#define ROPE_JOB_SIZE 64
+#define ROPE_BATCH 8 // Ropes stepped side by side
+
+// What every job of one UpdateRopes() call shares
+typedef struct RopeJob {
+    RopeSystem *ropes;
+    const int *indices;
+    Vector2 fall; // Gravity over one step, squared
+} RopeJob;
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void UpdateRopeRange(void *data, int start, int end);
+static void UpdateRopeBatch(RopePoint **points, const float *segmentLength, int count, Vector2 fall);
+
+// Setup
+// ----------------------------------------------------------------------------
+
+bool InitRopes(RopeSystem *ropes, int count, Arena *arena)
+{
+    size_t pointBytes = (size_t)count*ROPE_POINTS*sizeof(RopePoint);
+    size_t totalBytes = pointBytes + (size_t)count*sizeof(float);
+
+    *ropes = (RopeSystem){ 0 };
+    ropes->points = (arena != NULL)? ArenaAlloc(arena, totalBytes) : GameAlloc(totalBytes); // zeroed
+    ropes->ownsMemory = (arena == NULL);
+    if (ropes->points == NULL)
+    {
+        TraceLog(LOG_WARNING, "ROPE: Couldn't allocate %i ropes", count);
+        return false;
+    }
+
+    ropes->segmentLength = (float *)((unsigned char *)ropes->points + pointBytes);
+    ropes->count = count;
+    return true;
+}
+
+void FreeRopes(RopeSystem *ropes)
+{
+    if (ropes->ownsMemory) GameFree(ropes->points); // Arena memory goes with its arena
+    *ropes = (RopeSystem){ 0 };
+}
+
+void HangRope(RopeSystem *ropes, int rope, Vector2 anchor, Vector2 end)
+{
+    RopePoint *points = GetMutableRopePoints(ropes, rope);
+    for (int i = 0; i < ROPE_POINTS; i++)
+    {
+        points[i].position = Vector2Lerp(anchor, end, (float)i/ROPE_SEGMENTS);
+        points[i].previous = points[i].position;
+    }
+    ropes->segmentLength[rope] = Vector2Distance(anchor, end)/ROPE_SEGMENTS;
+}
+
+const RopePoint *GetRopePoints(const RopeSystem *ropes, int rope)
+{
+    return &ropes->points[rope*ROPE_POINTS];
+}
+
+RopePoint *GetMutableRopePoints(RopeSystem *ropes, int rope)
+{
+    return &ropes->points[rope*ROPE_POINTS];
+}
+
+float GetRopeEndAngle(const RopeSystem *ropes, int rope)
+{
+    const RopePoint *points = GetRopePoints(ropes, rope);
+    Vector2 direction = Vector2Subtract(points[ROPE_SEGMENTS].position, points[ROPE_SEGMENTS - 1].position);
+    return atan2f(-direction.x, direction.y)*RAD2DEG; // Straight down is 0, like Vector2Rotate() turns
+}
+
+// Update
+// ----------------------------------------------------------------------------
+
+void UpdateRopes(RopeSystem *ropes, const int *indices, int count, float gravity, float deltaTime)
+{
+    // Ropes don't affect each other, so many are split across threads
+    RopeJob job = { ropes, indices, { 0.0f, gravity*deltaTime*deltaTime } };
+    ParallelFor(count, ROPE_JOB_SIZE, UpdateRopeRange, &job);
+}
+
+static void UpdateRopeRange(void *data, int start, int end)
+{
+    RopeJob *job = data;
+    for (int first = start; first < end; first += ROPE_BATCH)
+    {
+        // A few ropes at a time, see UpdateRopeBatch()
+        RopePoint *points[ROPE_BATCH];
+        float segmentLength[ROPE_BATCH];
+        int count = (end - first < ROPE_BATCH)? end - first : ROPE_BATCH;
+        for (int i = 0; i < count; i++)
+        {
+            int rope = (job->indices != NULL)? job->indices[first + i] : first + i;
+            points[i] = GetMutableRopePoints(job->ropes, rope);
+            segmentLength[i] = job->ropes->segmentLength[rope];
+        }
+        UpdateRopeBatch(points, segmentLength, count, job->fall);
+    }
+}
+
+// Every segment waits on the one before it, a square root and a divide, so
+// one rope at a time mostly waits. Stepping a few ropes side by side gives
+// the CPU independent work to overlap.
+static void UpdateRopeBatch(RopePoint **points, const float *segmentLength, int count, Vector2 fall)
+{
+    // Keep moving the way each point moved last step, the first stays pinned
+    for (int r = 0; r < count; r++)
+    {
+        for (int i = 1; i < ROPE_POINTS; i++)
+        {
+            RopePoint *point = &points[r][i];
+            Vector2 velocity = Vector2Scale(Vector2Subtract(point->position, point->previous), ROPE_DAMPING);
+            point->previous = point->position;
+            point->position = Vector2Add(Vector2Add(point->position, velocity), fall);
+        }
+    }
+
+    // Pull every segment back to its length, each point moves by its share:
+    // none for the pinned one, less for the heavy end
+    for (int iteration = 0; iteration < ROPE_ITERATIONS; iteration++)
+    {
+        for (int i = 0; i < ROPE_SEGMENTS; i++)
+        {
+            float weightA = (i == 0)? 0.0f : 1.0f;
+            float weightB = (i + 1 == ROPE_SEGMENTS)? 1.0f/ROPE_END_WEIGHT : 1.0f;
+            for (int r = 0; r < count; r++)
+            {
+                RopePoint *a = &points[r][i];
+                RopePoint *b = &points[r][i + 1];
+                Vector2 delta = Vector2Subtract(b->position, a->position);
+                float length = Vector2Length(delta);
+                if (length <= EPSILON) continue;
+
+                float correction = (length - segmentLength[r])/(length*(weightA + weightB));
+                a->position = Vector2Add(a->position, Vector2Scale(delta, correction*weightA));
+                b->position = Vector2Subtract(b->position, Vector2Scale(delta, correction*weightB));
+            }
+        }
+    }
+}
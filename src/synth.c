@@ -0,0 +1,272 @@
+// EXPLANATION:
+// Procedural sound effects, synthesized on the audio thread
+// See synth.h for more documentation/descriptions
+
+#include "synth.h"
+#include "threads.h"
+#include "profiler.h"
+#include "raymath.h"
+
+#include <stddef.h> // NULL
+
+#define SYNTH_SUBBLOCK 32            // Frames between filter coefficient updates
+#define SYNTH_CLOCK_TOLERANCE 0.05   // Seconds the stream's clock may drift before it's set again
+#define QUEUE_INDEX_MASK (2*SYNTH_QUEUE_SIZE - 1) // Indices wrap at twice the size, so full and empty differ
+
+typedef enum { MESSAGE_WHOOSH, MESSAGE_PLAY } MessageType;
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+typedef struct SynthMessage {
+    MessageType type;
+    SynthSample sample;
+    float volume;
+    float pitch;
+    double time;   // When it's meant to happen, GetProfilerTime() clock
+} SynthMessage;
+
+typedef struct SynthVoice {
+    const float *data; // NULL when the voice is free
+    unsigned int length;
+    unsigned int position;
+    float volume;
+} SynthVoice;
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void PushMessage(SynthMessage message);
+static void SynthCallback(void *buffer, unsigned int frames);
+static void ApplyMessage(SynthMessage message);
+static void RenderWhoosh(float *output, unsigned int start, unsigned int end);
+static void RenderVoices(float *output, unsigned int start, unsigned int end);
+
+// Synth state
+static AudioStream synthStream = { 0 };
+static Wave samples[SYNTH_SAMPLE_COUNT] = { 0 }; // 32-bit float mono, read by the callback
+
+// Message queue, single producer (game thread) and single consumer (callback)
+static SynthMessage queue[SYNTH_QUEUE_SIZE];
+static volatile int queueWrite = 0;   // Only the game thread stores it
+static volatile int queueRead = 0;    // Only the callback stores it
+static unsigned int droppedMessages = 0;
+
+// Audio thread only
+static double clockStart = 0.0;       // Stream time of frame 0, set again if it drifts
+static long long framesRendered = 0;
+static SynthVoice voices[SYNTH_MAX_VOICES];
+static float volume = 0.0f;
+static float pitch = 1.0f;
+static float goalVolume = 0.0f;
+static float goalPitch = 1.0f;
+static float bandState = 0.0f;        // Filter integrators
+static float lowState = 0.0f;
+static unsigned int noiseState = 0x9E3779B9u;
+
+// Game thread
+// ----------------------------------------------------------------------------
+
+void LoadSynthSample(SynthSample sample, Wave wave)
+{
+    if (IsAudioStreamValid(synthStream))
+    {
+        TraceLog(LOG_WARNING, "SYNTH: Samples must be loaded before the synth starts");
+        UnloadWave(wave);
+        return;
+    }
+
+    UnloadWave(samples[sample]);
+    if (IsWaveValid(wave)) WaveFormat(&wave, SYNTH_SAMPLE_RATE, 32, 1);
+    samples[sample] = wave;
+}
+
+void StartSynth(void)
+{
+    if (!IsAudioDeviceReady() || IsAudioStreamValid(synthStream)) return;
+
+    // The callback isn't running yet, its state can be reset from here
+    queueWrite = queueRead = 0;
+    framesRendered = 0;
+    clockStart = 0.0;
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++) voices[i] = (SynthVoice){ 0 };
+    volume = goalVolume = 0.0f;
+    pitch = goalPitch = 1.0f;
+
+    SetAudioStreamBufferSizeDefault(SYNTH_BUFFER_FRAMES);
+    synthStream = LoadAudioStream(SYNTH_SAMPLE_RATE, 32, 1);
+    SetAudioStreamBufferSizeDefault(0); // Back to raylib's default for music
+    SetAudioStreamCallback(synthStream, SynthCallback);
+    PlayAudioStream(synthStream);
+}
+
+void StopSynth(void)
+{
+    if (IsAudioStreamValid(synthStream))
+    {
+        UnloadAudioStream(synthStream); // The callback has stopped once this returns
+        synthStream = (AudioStream){ 0 };
+        if (droppedMessages > 0) TraceLog(LOG_WARNING, "SYNTH: %u messages dropped, queue was full", droppedMessages);
+    }
+
+    for (int i = 0; i < SYNTH_SAMPLE_COUNT; i++)
+    {
+        UnloadWave(samples[i]);
+        samples[i] = (Wave){ 0 };
+    }
+}
+
+void SetWhoosh(float newVolume, float newPitch, double time)
+{
+    PushMessage((SynthMessage){ .type = MESSAGE_WHOOSH, .volume = newVolume, .pitch = newPitch, .time = time });
+}
+
+void PlaySynthSample(SynthSample sample, float sampleVolume, double time)
+{
+    PushMessage((SynthMessage){ .type = MESSAGE_PLAY, .sample = sample, .volume = sampleVolume, .time = time });
+}
+
+static void PushMessage(SynthMessage message)
+{
+    if (!IsAudioStreamValid(synthStream)) return;
+
+    int write = queueWrite;
+    int read = AtomicLoad(&queueRead);
+    if (((write - read) & QUEUE_INDEX_MASK) == SYNTH_QUEUE_SIZE)
+    {
+        droppedMessages++; // The callback has fallen behind (or the device stalled)
+        return;
+    }
+
+    queue[write & (SYNTH_QUEUE_SIZE - 1)] = message;
+    AtomicStore(&queueWrite, (write + 1) & QUEUE_INDEX_MASK); // Publishes the message
+}
+
+// Audio thread
+// ----------------------------------------------------------------------------
+
+// Renders up to each due message, applies it, and carries on
+static void SynthCallback(void *buffer, unsigned int frames)
+{
+    float *output = buffer;
+
+    // The stream's own clock, advanced by the frames it rendered so it doesn't
+    // jitter with the callback's timing
+    double now = GetProfilerTime();
+    double bufferTime = clockStart + (double)framesRendered/SYNTH_SAMPLE_RATE;
+    if ((clockStart == 0.0) || (fabs(now - bufferTime) > SYNTH_CLOCK_TOLERANCE))
+    {
+        clockStart = now;
+        framesRendered = 0;
+        bufferTime = now;
+    }
+
+    int read = queueRead;
+    int write = AtomicLoad(&queueWrite);
+    unsigned int frame = 0;
+    while (frame < frames)
+    {
+        // Messages are queued in time order, apply all that are due by now
+        unsigned int next = frames;
+        while (read != write)
+        {
+            SynthMessage message = queue[read & (SYNTH_QUEUE_SIZE - 1)];
+            double due = (message.time + SYNTH_SCHEDULE_DELAY - bufferTime)*SYNTH_SAMPLE_RATE;
+            if (due > frame)
+            {
+                if (due < next) next = (unsigned int)due;
+                break;
+            }
+
+            ApplyMessage(message);
+            read = (read + 1) & QUEUE_INDEX_MASK;
+        }
+
+        if (next <= frame) next = frame + 1;
+        RenderWhoosh(output, frame, next);
+        RenderVoices(output, frame, next);
+        frame = next;
+    }
+
+    AtomicStore(&queueRead, read); // Frees the slots for the game thread
+    framesRendered += frames;
+}
+
+static void ApplyMessage(SynthMessage message)
+{
+    if (message.type == MESSAGE_WHOOSH)
+    {
+        goalVolume = message.volume;
+        goalPitch = message.pitch;
+        return;
+    }
+
+    Wave sample = samples[message.sample];
+    if (sample.data == NULL) return;
+
+    // A free voice, or else the one that's played the longest
+    SynthVoice *voice = &voices[0];
+    for (int i = 0; i < SYNTH_MAX_VOICES; i++)
+    {
+        if (voices[i].data == NULL) { voice = &voices[i]; break; }
+        if (voices[i].position > voice->position) voice = &voices[i];
+    }
+    *voice = (SynthVoice){ sample.data, sample.frameCount, 0, message.volume };
+}
+
+// Band-passed white noise, through a state variable filter (trapezoidal,
+// stays stable when the cutoff moves)
+static void RenderWhoosh(float *output, unsigned int start, unsigned int end)
+{
+    float smoothing = 1.0f - expf(-1.0f/(SYNTH_SMOOTHING_TIME*SYNTH_SAMPLE_RATE));
+    float damping = 1.0f/WHOOSH_RESONANCE;
+
+    for (; start < end; start += SYNTH_SUBBLOCK)
+    {
+        unsigned int blockEnd = (start + SYNTH_SUBBLOCK < end)? start + SYNTH_SUBBLOCK : end;
+
+        // Coefficients once per sub-block, the cutoff barely moves within one
+        float cutoff = Clamp(WHOOSH_CUTOFF*pitch, 20.0f, 0.45f*SYNTH_SAMPLE_RATE);
+        float g = tanf(PI*cutoff/SYNTH_SAMPLE_RATE);
+        float a1 = 1.0f/(1.0f + g*(g + damping));
+        float a2 = g*a1;
+        float a3 = g*a2;
+        float level = WHOOSH_LEVEL/sqrtf(cutoff/WHOOSH_CUTOFF); // A wider band lets through more noise
+
+        for (unsigned int i = start; i < blockEnd; i++)
+        {
+            volume += (goalVolume - volume)*smoothing;
+            pitch += (goalPitch - pitch)*smoothing;
+
+            // xorshift32, scaled to -1..1
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            float noise = (float)(int)noiseState*(1.0f/2147483648.0f);
+
+            float v3 = noise - lowState;
+            float band = a1*bandState + a2*v3;
+            float low = lowState + a2*bandState + a3*v3;
+            bandState = 2.0f*band - bandState;
+            lowState = 2.0f*low - lowState;
+
+            output[i] = band*volume*level;
+        }
+    }
+}
+
+static void RenderVoices(float *output, unsigned int start, unsigned int end)
+{
+    for (int v = 0; v < SYNTH_MAX_VOICES; v++)
+    {
+        SynthVoice *voice = &voices[v];
+        if (voice->data == NULL) continue;
+
+        unsigned int count = end - start;
+        if (count > voice->length - voice->position) count = voice->length - voice->position;
+        const float *data = voice->data + voice->position;
+        for (unsigned int i = 0; i < count; i++)
+            output[start + i] += data[i]*voice->volume;
+
+        voice->position += count;
+        if (voice->position >= voice->length) voice->data = NULL;
+    }
+}
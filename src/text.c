@@ -0,0 +1,169 @@
+// EXPLANATION:
+// Cached text layout
+// See text.h for more documentation/descriptions
+
+#include "text.h"
+#include "rlgl.h"
+
+#include <string.h> // strncmp, strncpy
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static void LayoutText(TextLayout *layout, Font font);
+
+// Distance to the outline is in alpha, 0.5 on the edge. The edge is smoothed
+// over one screen pixel, however much the glyph is scaled. The width never
+// reaches 0 (flat areas), smoothstep() is undefined when its edges meet.
+#if defined(PLATFORM_WEB)
+static const char *sdfFragmentShader =
+    "#version 100\n"
+    "#extension GL_OES_standard_derivatives : enable\n"
+    "precision mediump float;\n"
+    "varying vec2 fragTexCoord;\n"
+    "varying vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = texture2D(texture0, fragTexCoord).a - 0.5;\n"
+    "#ifdef GL_OES_standard_derivatives\n"
+    "    float width = max(length(vec2(dFdx(distance), dFdy(distance))), 1e-4);\n"
+    "#else\n"
+    "    float width = 0.05;\n"
+    "#endif\n"
+    "    float alpha = smoothstep(-width, width, distance);\n"
+    "    gl_FragColor = vec4(fragColor.rgb, fragColor.a*alpha)*colDiffuse;\n"
+    "}\n";
+#else
+static const char *sdfFragmentShader =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = texture(texture0, fragTexCoord).a - 0.5;\n"
+    "    float width = max(length(vec2(dFdx(distance), dFdy(distance))), 1e-4);\n"
+    "    float alpha = smoothstep(-width, width, distance);\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a*alpha)*colDiffuse;\n"
+    "}\n";
+#endif
+
+// Cache state
+static TextLayout textCache[TEXT_CACHE_SIZE];
+static unsigned int textCacheClock = 0; // Bumped on every lookup, for least recently used
+
+// Layout
+// ----------------------------------------------------------------------------
+
+const TextLayout *GetTextLayout(Font font, const char *text, float fontSize, float spacing)
+{
+    textCacheClock++;
+
+    TextLayout *oldest = &textCache[0];
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++)
+    {
+        TextLayout *layout = &textCache[i];
+        if ((layout->fontId == font.texture.id) && (layout->fontSize == fontSize) &&
+            (layout->spacing == spacing) && (strncmp(layout->text, text, TEXT_MAX_LENGTH - 1) == 0))
+        {
+            layout->lastUsed = textCacheClock;
+            return layout;
+        }
+
+        if (layout->lastUsed < oldest->lastUsed) oldest = layout;
+    }
+
+    // Not cached, lay it out in place of the least recently used
+    *oldest = (TextLayout){ .fontId = font.texture.id, .fontSize = fontSize, .spacing = spacing,
+                            .lastUsed = textCacheClock };
+    strncpy(oldest->text, text, TEXT_MAX_LENGTH - 1);
+    LayoutText(oldest, font);
+    return oldest;
+}
+
+void ClearTextCache(void)
+{
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++)
+        textCache[i] = (TextLayout){ 0 };
+}
+
+// Same placement as DrawTextEx() and DrawTextCodepoint(), same size as MeasureTextEx()
+static void LayoutText(TextLayout *layout, Font font)
+{
+    float scale = layout->fontSize/font.baseSize;
+    float padding = (float)font.glyphPadding;
+    float offsetX = 0.0f;
+    float measuredWidth = 0.0f;
+    int codepointCount = 0;
+
+    for (int i = 0; layout->text[i] != '\0';)
+    {
+        int codepointSize = 0;
+        int codepoint = GetCodepointNext(&layout->text[i], &codepointSize);
+        int index = GetGlyphIndex(font, codepoint);
+        GlyphInfo glyph = font.glyphs[index];
+        Rectangle rec = font.recs[index];
+        i += codepointSize;
+        codepointCount++;
+
+        if ((codepoint != ' ') && (codepoint != '\t'))
+        {
+            layout->glyphs[layout->glyphCount++] = (TextGlyph){
+                .source = { rec.x - padding, rec.y - padding, rec.width + 2.0f*padding, rec.height + 2.0f*padding },
+                .destination = { offsetX + (glyph.offsetX - padding)*scale, (glyph.offsetY - padding)*scale,
+                                 (rec.width + 2.0f*padding)*scale, (rec.height + 2.0f*padding)*scale },
+            };
+        }
+
+        offsetX += ((glyph.advanceX == 0)? rec.width : (float)glyph.advanceX)*scale + layout->spacing;
+        measuredWidth += (glyph.advanceX > 0)? (float)glyph.advanceX : rec.width + glyph.offsetX;
+    }
+
+    layout->size.x = (codepointCount > 0)? measuredWidth*scale + (codepointCount - 1)*layout->spacing : 0.0f;
+    layout->size.y = layout->fontSize;
+}
+
+// Draw
+// ----------------------------------------------------------------------------
+
+void DrawTextLayout(const TextLayout *layout, Font font, Vector2 position, Color tint)
+{
+    if ((layout->glyphCount == 0) || (font.texture.id != layout->fontId)) return;
+
+    float width = (float)font.texture.width;
+    float height = (float)font.texture.height;
+
+    // All the glyphs as one run of quads, like DrawTexturePro() draws each
+    rlCheckRenderBatchLimit(4*layout->glyphCount);
+    rlSetTexture(font.texture.id);
+    rlBegin(RL_QUADS);
+        rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+
+        for (int i = 0; i < layout->glyphCount; i++)
+        {
+            Rectangle source = layout->glyphs[i].source;
+            Rectangle destination = layout->glyphs[i].destination;
+            float left = position.x + destination.x;
+            float top = position.y + destination.y;
+
+            rlTexCoord2f(source.x/width, source.y/height);
+            rlVertex2f(left, top);
+            rlTexCoord2f(source.x/width, (source.y + source.height)/height);
+            rlVertex2f(left, top + destination.height);
+            rlTexCoord2f((source.x + source.width)/width, (source.y + source.height)/height);
+            rlVertex2f(left + destination.width, top + destination.height);
+            rlTexCoord2f((source.x + source.width)/width, source.y/height);
+            rlVertex2f(left + destination.width, top);
+        }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+Shader LoadSdfShader(void)
+{
+    return LoadShaderFromMemory(NULL, sdfFragmentShader); // raylib's default vertex shader
+}
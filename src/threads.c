@@ -0,0 +1,220 @@
+// EXPLANATION:
+// Minimal threads and atomics over pthreads and Win32
+// See threads.h for more documentation/descriptions
+
+#include "threads.h"
+
+#include <stdint.h> // uintptr_t
+#include <string.h> // memcpy
+
+#if defined(PLATFORM_WEB)
+    // No threads
+#elif defined(_WIN32)
+    // Declared by hand, windows.h clashes with raylib's names
+    __declspec(dllimport) unsigned long __stdcall WaitForSingleObject(void *handle, unsigned long milliseconds);
+    __declspec(dllimport) int __stdcall CloseHandle(void *handle);
+    __declspec(dllimport) void *__stdcall CreateSemaphoreW(void *attributes, long initialCount, long maximumCount, const unsigned short *name);
+    __declspec(dllimport) int __stdcall ReleaseSemaphore(void *semaphore, long releaseCount, long *previousCount);
+    __declspec(dllimport) int __stdcall SwitchToThread(void);
+    __declspec(dllimport) unsigned long __stdcall GetActiveProcessorCount(unsigned short groupNumber);
+    uintptr_t __cdecl _beginthreadex(void *security, unsigned int stackSize,
+                                              unsigned int (__stdcall *start)(void *), void *arg,
+                                              unsigned int flags, unsigned int *threadId);
+    #define WIN32_INFINITE 0xFFFFFFFFul
+    #define WIN32_ALL_PROCESSOR_GROUPS 0xFFFF
+    #define WIN32_SEMAPHORE_MAX 0x7FFFFFFFl
+#else
+    #include <pthread.h>
+    #include <sched.h>  // sched_yield
+    #include <unistd.h> // sysconf
+    typedef char ThreadHandleFits[(sizeof(pthread_t) <= sizeof(((Thread *)0)->handle))? 1 : -1];
+
+    // A counting semaphore from a mutex and a condition, POSIX semaphores
+    // aren't there on macOS
+    typedef struct PosixSemaphore {
+        pthread_mutex_t mutex;
+        pthread_cond_t condition;
+        int count;
+    } PosixSemaphore;
+    typedef char SemaphoreFits[(sizeof(PosixSemaphore) <= sizeof(((Semaphore *)0)->handle))? 1 : -1];
+#endif
+
+// What a new thread runs
+typedef struct ThreadStart {
+    ThreadFunc func;
+    void *arg;
+} ThreadStart;
+
+// Each thread gets its own slot for good, the game only ever starts a few
+#define MAX_THREAD_STARTS 16
+static ThreadStart threadStarts[MAX_THREAD_STARTS];
+static volatile int threadStartCount = 0;
+
+#if !defined(PLATFORM_WEB)
+#if defined(_WIN32)
+static unsigned int __stdcall RunThread(void *arg)
+#else
+static void *RunThread(void *arg)
+#endif
+{
+    ThreadStart *start = arg;
+    int result = start->func(start->arg);
+#if defined(_WIN32)
+    return (unsigned int)result;
+#else
+    return (void *)(long)result;
+#endif
+}
+#endif
+
+bool StartThread(Thread *thread, ThreadFunc func, void *arg)
+{
+    thread->started = false;
+#if defined(PLATFORM_WEB)
+    (void)func;
+    (void)arg;
+    return false;
+#else
+    int slot = AtomicAdd(&threadStartCount, 1) - 1;
+    if (slot >= MAX_THREAD_STARTS) return false;
+    threadStarts[slot] = (ThreadStart){ func, arg };
+
+#if defined(_WIN32)
+    uintptr_t handle = _beginthreadex(NULL, 0, RunThread, &threadStarts[slot], 0, NULL);
+    if (handle == 0) return false;
+    void *handlePointer = (void *)handle;
+    memcpy(thread->handle, &handlePointer, sizeof(handlePointer));
+#else
+    pthread_t handle;
+    if (pthread_create(&handle, NULL, RunThread, &threadStarts[slot]) != 0) return false;
+    memcpy(thread->handle, &handle, sizeof(handle));
+#endif
+
+    thread->started = true;
+    return true;
+#endif
+}
+
+void JoinThread(Thread *thread)
+{
+    if (!thread->started) return;
+
+#if defined(PLATFORM_WEB)
+    // Never started
+#elif defined(_WIN32)
+    void *handle;
+    memcpy(&handle, thread->handle, sizeof(handle));
+    WaitForSingleObject(handle, WIN32_INFINITE);
+    CloseHandle(handle);
+#else
+    pthread_t handle;
+    memcpy(&handle, thread->handle, sizeof(handle));
+    pthread_join(handle, NULL);
+#endif
+
+    thread->started = false;
+}
+
+bool AreThreadsAvailable(void)
+{
+#if defined(PLATFORM_WEB)
+    return false;
+#else
+    return true;
+#endif
+}
+
+int GetCpuCount(void)
+{
+#if defined(PLATFORM_WEB)
+    return 1;
+#elif defined(_WIN32)
+    int count = (int)GetActiveProcessorCount(WIN32_ALL_PROCESSOR_GROUPS);
+    return (count > 0)? count : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0)? (int)count : 1;
+#endif
+}
+
+void YieldThread(void)
+{
+#if defined(PLATFORM_WEB)
+    // Nothing else to run
+#elif defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// Semaphores
+// ----------------------------------------------------------------------------
+
+void InitSemaphore(Semaphore *semaphore)
+{
+#if defined(PLATFORM_WEB)
+    (void)semaphore;
+#elif defined(_WIN32)
+    void *handle = CreateSemaphoreW(NULL, 0, WIN32_SEMAPHORE_MAX, NULL);
+    memcpy(semaphore->handle, &handle, sizeof(handle));
+#else
+    PosixSemaphore *posix = (PosixSemaphore *)semaphore->handle;
+    pthread_mutex_init(&posix->mutex, NULL);
+    pthread_cond_init(&posix->condition, NULL);
+    posix->count = 0;
+#endif
+}
+
+void DestroySemaphore(Semaphore *semaphore)
+{
+#if defined(PLATFORM_WEB)
+    (void)semaphore;
+#elif defined(_WIN32)
+    void *handle;
+    memcpy(&handle, semaphore->handle, sizeof(handle));
+    if (handle != NULL) CloseHandle(handle);
+#else
+    PosixSemaphore *posix = (PosixSemaphore *)semaphore->handle;
+    pthread_cond_destroy(&posix->condition);
+    pthread_mutex_destroy(&posix->mutex);
+#endif
+}
+
+void PostSemaphore(Semaphore *semaphore, int count)
+{
+    if (count <= 0) return;
+
+#if defined(PLATFORM_WEB)
+    (void)semaphore;
+#elif defined(_WIN32)
+    void *handle;
+    memcpy(&handle, semaphore->handle, sizeof(handle));
+    ReleaseSemaphore(handle, count, NULL);
+#else
+    PosixSemaphore *posix = (PosixSemaphore *)semaphore->handle;
+    pthread_mutex_lock(&posix->mutex);
+    posix->count += count;
+    if (count == 1) pthread_cond_signal(&posix->condition);
+    else pthread_cond_broadcast(&posix->condition);
+    pthread_mutex_unlock(&posix->mutex);
+#endif
+}
+
+void WaitSemaphore(Semaphore *semaphore)
+{
+#if defined(PLATFORM_WEB)
+    (void)semaphore; // Never waited on, there's no other thread to post
+#elif defined(_WIN32)
+    void *handle;
+    memcpy(&handle, semaphore->handle, sizeof(handle));
+    WaitForSingleObject(handle, WIN32_INFINITE);
+#else
+    PosixSemaphore *posix = (PosixSemaphore *)semaphore->handle;
+    pthread_mutex_lock(&posix->mutex);
+    while (posix->count == 0)
+        pthread_cond_wait(&posix->condition, &posix->mutex);
+    posix->count--;
+    pthread_mutex_unlock(&posix->mutex);
+#endif
+}
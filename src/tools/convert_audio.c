@@ -0,0 +1,295 @@
+// EXPLANATION:
+// Converts 16-bit WAV files to QOA, the compressed format the game ships
+// QOA ("Quite OK Audio", https://qoaformat.org) stores 3.2 bits per sample,
+// a fifth of 16-bit PCM, and raylib decodes it cheaply both when loading a
+// sound and when streaming music. This is a small standalone encoder for the
+// format, so the conversion step needs nothing but a C compiler.
+//
+// Usage: convert_audio <input.wav> <output.qoa>
+
+#include <stdbool.h> // bool
+#include <stdio.h>   // FILE, printf
+#include <stdlib.h>  // malloc
+#include <string.h>  // memcmp
+
+#define QOA_SLICE_LEN 20
+#define QOA_SLICES_PER_FRAME 256
+#define QOA_FRAME_LEN (QOA_SLICES_PER_FRAME*QOA_SLICE_LEN)
+#define QOA_LMS_LEN 4
+#define QOA_MAX_CHANNELS 8
+
+// Types and Structures
+// ----------------------------------------------------------------------------
+
+typedef struct Wav {
+    short *samples; // Interleaved
+    unsigned int frameCount;
+    unsigned int sampleRate;
+    unsigned int channels;
+} Wav;
+
+// Sign-sign LMS predictor, one per channel
+typedef struct QoaLms {
+    int history[QOA_LMS_LEN];
+    int weights[QOA_LMS_LEN];
+} QoaLms;
+
+// Local Functions Declaration
+// ----------------------------------------------------------------------------
+static bool LoadWav(const char *fileName, Wav *wav);
+static bool WriteQoa(const char *fileName, Wav wav);
+static void EncodeQoaFrame(FILE *file, Wav wav, unsigned int start, unsigned int length, QoaLms *lms, int *lastScale);
+static int PredictLms(const QoaLms *lms);
+static void UpdateLms(QoaLms *lms, int sample, int residual);
+static int DivideScaled(int value, int scale);
+static void WriteU64(FILE *file, unsigned long long value);
+
+// Quantization tables from the QOA specification
+static const int scalefactors[16] = { 1, 7, 21, 45, 84, 138, 211, 304, 421, 562, 731, 928, 1157, 1419, 1715, 2048 };
+static const int quantized[17] = { 7, 7, 7, 5, 5, 3, 3, 1, 0, 0, 2, 2, 4, 4, 6, 6, 6 }; // Index is residual + 8
+static const float dequantized[8] = { 0.75f, -0.75f, 2.5f, -2.5f, 4.5f, -4.5f, 7.0f, -7.0f };
+static int dequantTable[16][8];
+static int reciprocals[16];
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        printf("Usage: convert_audio <input.wav> <output.qoa>\n");
+        return 1;
+    }
+
+    for (int s = 0; s < 16; s++)
+    {
+        reciprocals[s] = ((1 << 16) + scalefactors[s] - 1)/scalefactors[s];
+        for (int q = 0; q < 8; q++)
+        {
+            float value = scalefactors[s]*dequantized[q];
+            dequantTable[s][q] = (int)((value < 0)? value - 0.5f : value + 0.5f);
+        }
+    }
+
+    Wav wav = { 0 };
+    if (!LoadWav(argv[1], &wav)) return 1;
+
+    bool written = WriteQoa(argv[2], wav);
+    free(wav.samples);
+    if (!written) return 1;
+
+    printf("Converted %s to %s (%u Hz, %u channels, %.1f s)\n", argv[1], argv[2],
+           wav.sampleRate, wav.channels, (float)wav.frameCount/(float)wav.sampleRate);
+    return 0;
+}
+
+// Reads the fmt and data chunks of a 16-bit PCM wav file
+static bool LoadWav(const char *fileName, Wav *wav)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL)
+    {
+        printf("Couldn't open %s\n", fileName);
+        return false;
+    }
+
+    unsigned char riff[12];
+    bool valid = (fread(riff, 1, 12, file) == 12) && (memcmp(riff, "RIFF", 4) == 0) && (memcmp(riff + 8, "WAVE", 4) == 0);
+    unsigned int bitsPerSample = 0;
+    unsigned int format = 0;
+
+    unsigned char chunk[8];
+    while (valid && (fread(chunk, 1, 8, file) == 8))
+    {
+        unsigned int size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((unsigned int)chunk[7] << 24);
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            unsigned char fmt[16];
+            valid = (size >= 16) && (fread(fmt, 1, 16, file) == 16);
+            format = fmt[0] | (fmt[1] << 8);
+            wav->channels = fmt[2] | (fmt[3] << 8);
+            wav->sampleRate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((unsigned int)fmt[7] << 24);
+            bitsPerSample = fmt[14] | (fmt[15] << 8);
+            fseek(file, (long)(size - 16 + (size & 1)), SEEK_CUR);
+        }
+        else if ((memcmp(chunk, "data", 4) == 0) && (wav->channels > 0))
+        {
+            valid = (format == 1) && (bitsPerSample == 16) && (wav->channels <= QOA_MAX_CHANNELS);
+            if (!valid) break;
+
+            wav->frameCount = size/(2*wav->channels);
+            wav->samples = malloc((size_t)wav->frameCount*wav->channels*sizeof(short));
+            unsigned char *bytes = malloc(size);
+            valid = (wav->samples != NULL) && (bytes != NULL) && (fread(bytes, 1, size, file) == size);
+            for (unsigned int i = 0; valid && (i < wav->frameCount*wav->channels); i++)
+                wav->samples[i] = (short)(bytes[2*i] | (bytes[2*i + 1] << 8));
+            free(bytes);
+            break;
+        }
+        else fseek(file, (long)(size + (size & 1)), SEEK_CUR);
+    }
+    fclose(file);
+
+    if (!valid || (wav->samples == NULL))
+    {
+        printf("%s isn't a 16-bit PCM wav file\n", fileName);
+        free(wav->samples);
+        wav->samples = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static bool WriteQoa(const char *fileName, Wav wav)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL)
+    {
+        printf("Couldn't create %s\n", fileName);
+        return false;
+    }
+
+    // File header: magic and samples per channel, big-endian
+    WriteU64(file, (0x716f6166ull << 32) | wav.frameCount); // "qoaf"
+
+    QoaLms lms[QOA_MAX_CHANNELS];
+    int lastScale[QOA_MAX_CHANNELS] = { 0 };
+    for (unsigned int c = 0; c < wav.channels; c++)
+    {
+        lms[c] = (QoaLms){ .weights = { 0, 0, -(1 << 13), (1 << 14) } };
+    }
+
+    for (unsigned int start = 0; start < wav.frameCount; start += QOA_FRAME_LEN)
+    {
+        unsigned int length = wav.frameCount - start;
+        if (length > QOA_FRAME_LEN) length = QOA_FRAME_LEN;
+        EncodeQoaFrame(file, wav, start, length, lms, lastScale);
+    }
+
+    bool written = (ferror(file) == 0);
+    fclose(file);
+    return written;
+}
+
+static void EncodeQoaFrame(FILE *file, Wav wav, unsigned int start, unsigned int length, QoaLms *lms, int *lastScale)
+{
+    unsigned int channels = wav.channels;
+    unsigned int slices = (length + QOA_SLICE_LEN - 1)/QOA_SLICE_LEN;
+    unsigned int frameSize = 8 + QOA_LMS_LEN*4*channels + 8*slices*channels;
+
+    // Frame header, then the predictor state each channel starts the frame with
+    WriteU64(file, ((unsigned long long)channels << 56) | ((unsigned long long)wav.sampleRate << 32) |
+                   ((unsigned long long)length << 16) | frameSize);
+    for (unsigned int c = 0; c < channels; c++)
+    {
+        unsigned long long history = 0;
+        unsigned long long weights = 0;
+        for (int i = 0; i < QOA_LMS_LEN; i++)
+        {
+            history = (history << 16) | (lms[c].history[i] & 0xffff);
+            weights = (weights << 16) | (lms[c].weights[i] & 0xffff);
+        }
+        WriteU64(file, history);
+        WriteU64(file, weights);
+    }
+
+    for (unsigned int sliceStart = start; sliceStart < start + length; sliceStart += QOA_SLICE_LEN)
+    {
+        unsigned int sliceLength = start + length - sliceStart;
+        if (sliceLength > QOA_SLICE_LEN) sliceLength = QOA_SLICE_LEN;
+
+        for (unsigned int c = 0; c < channels; c++)
+        {
+            // Try every scalefactor and keep the one with the least error,
+            // starting from the last one since it's the most likely
+            unsigned long long bestError = ~0ull;
+            unsigned long long bestSlice = 0;
+            QoaLms bestLms = lms[c];
+            int bestScale = lastScale[c];
+
+            for (int s = 0; s < 16; s++)
+            {
+                int scale = (s + lastScale[c])%16;
+                QoaLms trial = lms[c];
+                unsigned long long slice = (unsigned long long)scale;
+                unsigned long long error = 0;
+
+                for (unsigned int i = sliceStart; i < sliceStart + sliceLength; i++)
+                {
+                    int sample = wav.samples[i*channels + c];
+                    int predicted = PredictLms(&trial);
+                    int scaled = DivideScaled(sample - predicted, scale);
+                    if (scaled < -8) scaled = -8;
+                    if (scaled > 8) scaled = 8;
+                    int quant = quantized[scaled + 8];
+                    int dequant = dequantTable[scale][quant];
+                    int reconstructed = predicted + dequant;
+                    if (reconstructed < -32768) reconstructed = -32768;
+                    if (reconstructed > 32767) reconstructed = 32767;
+
+                    // Runaway predictor weights blow up later slices, penalize them
+                    long long penalty = (((long long)trial.weights[0]*trial.weights[0] + (long long)trial.weights[1]*trial.weights[1] +
+                                          (long long)trial.weights[2]*trial.weights[2] + (long long)trial.weights[3]*trial.weights[3]) >> 18) - 0x8ff;
+                    if (penalty < 0) penalty = 0;
+
+                    long long difference = sample - reconstructed;
+                    error += (unsigned long long)(difference*difference + penalty*penalty);
+                    if (error > bestError) break;
+
+                    UpdateLms(&trial, reconstructed, dequant);
+                    slice = (slice << 3) | (unsigned long long)quant;
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestSlice = slice;
+                    bestLms = trial;
+                    bestScale = scale;
+                }
+            }
+
+            lms[c] = bestLms;
+            lastScale[c] = bestScale;
+
+            // A short last slice is padded with zero residuals at the end
+            bestSlice <<= (QOA_SLICE_LEN - sliceLength)*3;
+            WriteU64(file, bestSlice);
+        }
+    }
+}
+
+static int PredictLms(const QoaLms *lms)
+{
+    int prediction = 0;
+    for (int i = 0; i < QOA_LMS_LEN; i++)
+        prediction += lms->weights[i]*lms->history[i];
+
+    return prediction >> 13;
+}
+
+static void UpdateLms(QoaLms *lms, int sample, int residual)
+{
+    int delta = residual >> 4;
+    for (int i = 0; i < QOA_LMS_LEN; i++)
+        lms->weights[i] += (lms->history[i] < 0)? -delta : delta;
+
+    for (int i = 0; i < QOA_LMS_LEN - 1; i++)
+        lms->history[i] = lms->history[i + 1];
+    lms->history[QOA_LMS_LEN - 1] = sample;
+}
+
+// Rounding division by a scalefactor, without a divide
+static int DivideScaled(int value, int scale)
+{
+    int n = (int)(((long long)value*reciprocals[scale] + (1 << 15)) >> 16);
+    return n + ((value > 0) - (value < 0)) - ((n > 0) - (n < 0)); // Round away from zero
+}
+
+static void WriteU64(FILE *file, unsigned long long value)
+{
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++)
+        bytes[i] = (unsigned char)(value >> (56 - 8*i));
+
+    fwrite(bytes, 1, 8, file);
+}
@@ -0,0 +1,91 @@
+// EXPLANATION:
+// Packs asset files into one archive for the game to map at startup
+// The format is described in archive.h. Each file is stored under the path
+// given on the command line, which is the path the game loads it by.
+//
+// Usage: pack_assets <archive> <files...>
+// e.g.   pack_assets assets.pak assets/*
+
+#include "archive.h"
+
+#include <stdio.h>  // FILE, printf
+#include <stdlib.h> // malloc
+#include <string.h> // strlen, strncpy
+
+#define MAX_ASSETS 256
+
+static unsigned char padding[ARCHIVE_ALIGNMENT];
+
+int main(int argc, char **argv)
+{
+    if ((argc < 3) || (argc - 2 > MAX_ASSETS))
+    {
+        printf("Usage: pack_assets <archive> <files...> (up to %i files)\n", MAX_ASSETS);
+        return 1;
+    }
+
+    int count = argc - 2;
+    char **files = argv + 2;
+    static ArchiveEntry entries[MAX_ASSETS];
+
+    // Lay out the entry table, then the data of each file
+    unsigned long offset = sizeof(ArchiveHeader) + count*sizeof(ArchiveEntry);
+    for (int i = 0; i < count; i++)
+    {
+        if (strlen(files[i]) >= ARCHIVE_NAME_LENGTH)
+        {
+            printf("Name too long (max %i): %s\n", ARCHIVE_NAME_LENGTH - 1, files[i]);
+            return 1;
+        }
+
+        FILE *file = fopen(files[i], "rb");
+        if (file == NULL)
+        {
+            printf("Couldn't open %s\n", files[i]);
+            return 1;
+        }
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fclose(file);
+
+        offset = (offset + ARCHIVE_ALIGNMENT - 1)/ARCHIVE_ALIGNMENT*ARCHIVE_ALIGNMENT;
+        strncpy(entries[i].name, files[i], ARCHIVE_NAME_LENGTH - 1);
+        entries[i].offset = (unsigned int)offset;
+        entries[i].size = (unsigned int)size;
+        offset += (unsigned long)size;
+    }
+
+    FILE *archive = fopen(argv[1], "wb");
+    if (archive == NULL)
+    {
+        printf("Couldn't create %s\n", argv[1]);
+        return 1;
+    }
+
+    ArchiveHeader header = { ARCHIVE_MAGIC, ARCHIVE_VERSION, (unsigned int)count, 0 };
+    fwrite(&header, sizeof(header), 1, archive);
+    fwrite(entries, sizeof(ArchiveEntry), (size_t)count, archive);
+
+    for (int i = 0; i < count; i++)
+    {
+        fwrite(padding, 1, entries[i].offset - (unsigned long)ftell(archive), archive);
+
+        unsigned char *data = malloc(entries[i].size + 1);
+        FILE *file = fopen(files[i], "rb");
+        size_t read = fread(data, 1, entries[i].size, file);
+        fclose(file);
+        fwrite(data, 1, read, archive);
+        free(data);
+
+        if (read != entries[i].size)
+        {
+            printf("Couldn't read %s\n", files[i]);
+            fclose(archive);
+            return 1;
+        }
+    }
+
+    printf("Packed %i files into %s (%lu KB)\n", count, argv[1], offset/1024);
+    fclose(archive);
+    return 0;
+}